@@ -0,0 +1,41 @@
+//  SPDX-FileCopyrightText: 2016 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <stdio.h>
+#include "amplify.h"
+
+void calcWindowAmplification(struct Window* window, double loudness, const int IS_LEVELER, const double input_gain) {
+    window->oldLoudness = window->loudness;
+    window->loudness = loudness;
+
+    window->oldAmplification = window->amplification;
+    const int IS_LIMITER = !IS_LEVELER;
+
+    if (window->loudness < MIN_LOUDNESS || (IS_LIMITER && window->loudness <= window->target)) {
+        // Compensate 3dB if leveler is gated or limiter is idle
+        window->amplification = DB3 * 1.0 / input_gain;
+        return;
+    } else {
+        // Active Leveling/Limiting
+        window->amplification = getAmplification(window->target, window->loudness, window->oldLoudness,
+            window->amplification);
+    }
+    // Constraints (Slew Rate / Max Change)
+    double maxAllowed = window->oldAmplification + window->maxAmpChange;
+    if (window->amplification > maxAllowed) {
+        window->amplification = maxAllowed;
+    }
+    // Hard Ceiling for Limiter mode
+    if (IS_LIMITER && window->amplification > 1.0 ) {
+        window->amplification = 1.0;
+    }
+}
+
+void printWindow(struct Window* window, int isLast) {
+    fprintf(stderr, "%.1f\t%2.3f\t%2.3f\t%2.3f", window->position, window->loudness, (window->target - window->loudness), window->amplification);
+    if (isLast) {
+        fprintf(stderr, "\n");
+    } else {
+        fprintf(stderr, "  ");
+    }
+}
@@ -11,34 +11,58 @@
 #include "window.h"
 
 // target loudness, should be -20 DB
-const double TARGET_LOUDNESS = -20.0;
+static const double TARGET_LOUDNESS = -20.0;
 // how often update statistics
-const double ADJUST_RATE = 0.333;
+static const double ADJUST_RATE = 0.333;
 // compression start = -3dB
-const double compressionStart = 0.707945784;
+static const double compressionStart = 0.707945784;
 // maximum level = -1dB
-const double MAX_LEVEL = 0.891250938;
+static const double MAX_LEVEL = 0.891250938;
 // minimum loudness = -40dB =0.01
-const double MIN_LOUDNESS = -40.0;
+static const double MIN_LOUDNESS = -40.0;
 // max amplication change per second
-const double MAX_CHANGE = 0.7;
+static const double MAX_CHANGE = 0.7;
 
-const double DB3 = sqrt(2);
+static const double DB3 = sqrt(2);
 
-inline double getDb(double a) {
+static inline double getDb(double a) {
     if (a == 0.0) a = 0.0000000000001;
     return 20.0 * log10(sqrt(a));
 }
 
-inline double getRmsValue(const double rmsSum, const double size) {
+// level in dB of an amplitude, e.g. a sample or true peak
+static inline double getDbAmplitude(double a) {
+    if (a == 0.0) a = 0.000000316227766;
+    return 20.0 * log10(a);
+}
+
+static inline double getRmsValue(const double rmsSum, const double size) {
     double sum = rmsSum / size;
     return getDb(sum);
 }
 
-inline double getAmplification(const double loudness, const double oldLoudness, const double oldAmp) {
+// loudness of all channels of a window
+static inline double getWindowLoudness(struct Window* window) {
+    return getRmsValue(window->sumSquare, window->powerSize * window->channels);
+}
+
+// loudness in LUFS of a window fed with K-weighted power, the sum of all channels as in ITU-R BS.1770
+static inline double getWindowLufs(struct Window* window) {
+    return -0.691 + getRmsValue(window->sumSquare, window->powerSize);
+}
+
+// loudness of a range of the power history of a window
+static inline double getWindowRangeLoudness(struct Window* window, int r) {
+    const struct WindowRange* range = &window->range[r];
+    if (range->skip > 0) return getRmsValue(range->sumSquare, range->frames * window->channels);
+    return getRmsValue(range->sumSquare + window->blockPower, (range->frames + window->blockPosition) * window->channels);
+}
+
+static inline double getAmplification(const double target, const double loudness, const double oldLoudness,
+        const double oldAmp) {
     if (loudness < MIN_LOUDNESS) return oldAmp;
     // get target factor from loudness delta
-    double amp = pow(10., (TARGET_LOUDNESS - loudness) / 20.0);
+    double amp = pow(10., (target - loudness) / 20.0);
     if (isnan(amp)) amp = 1.;
     if (amp == 0.) amp = 1.;
     // on decreasing loudness do not increase amplification
@@ -46,70 +70,51 @@ inline double getAmplification(const double loudness, const double oldLoudness,
     return amp;
 }
 
-inline double interpolateAmplification(const double amp, const double oldAmp, double pos, const double maxPos) {
-    if (pos > maxPos) pos = maxPos;
-    if (pos < 0)      pos = 0;
-    if (amp == oldAmp || pos == maxPos) return amp;
-    double x = pos / maxPos;
-    double proportion = x * x * (3 - 2 * x);
-    double amplification = (proportion * amp) + ((1.0 - proportion) * oldAmp);
-    return amplification;
-}
-
-// compress by logarithm function (up to 10)
-// scale by compressionFactor to limit value to -1 dB
-// log10(1)=0, log10(10)=1
-inline double compress(const double value) {
-    const double factor = (1.0 - compressionStart);
-    return factor * log10(value + 1.0);
+// blend from oldAmp to amp along the shared ramp at the adjust position of the window
+static inline double interpolateAmplification(const struct Window* window, const double amp, const double oldAmp) {
+    return oldAmp + window->ramp[window->adjustPosition] * (amp - oldAmp);
 }
 
-// limit value by linear compression of values louder than compressionStart (-3dB) to reach a maximum of -1dB
-inline double limit(double value) {
-    double amplitude = value;
-    if (value < 0.0) amplitude = -amplitude;
-    if (amplitude > compressionStart)
-        amplitude = compressionStart + compress(amplitude - compressionStart);
-    if (value < 0.0) amplitude = -amplitude;
-
-    if (amplitude > MAX_LEVEL)  amplitude = MAX_LEVEL;
-    if (amplitude < -MAX_LEVEL) amplitude = -MAX_LEVEL;
-    return amplitude;
+// Soft clip of values louder than compressionStart (-3dB) to reach a maximum of -1dB, following
+// compressionStart + (1 - compressionStart) * log10(amplitude - compressionStart + 1).
+// With u = amplitude - compressionStart and s = u / (u + 2) the logarithm is log10((1 + s) / (1 - s)),
+// an odd function of s, approximated by s * P(s^2) with a degree 7 Chebyshev fit of P.
+// u is clamped where the curve reaches MAX_LEVEL, so s^2 stays within [0, 0.383].
+// Maximum error against the logarithm is 9e-10 (1/60 of a float ulp at -1dB), about 0.5% of the
+// clipped samples round to a neighbouring float. Values up to compressionStart pass unchanged.
+
+// amplitude above compressionStart at which the curve reaches MAX_LEVEL
+static const double LIMIT_RANGE = 3.242685520531867;
+// coefficients of P, lowest order first
+static const double LIMIT_P0 = 0.25367506768114351;
+static const double LIMIT_P1 = 0.084558737691276545;
+static const double LIMIT_P2 = 0.050714744725186785;
+static const double LIMIT_P3 = 0.036645622190122872;
+static const double LIMIT_P4 = 0.02424717654971132;
+static const double LIMIT_P5 = 0.043257006086568239;
+static const double LIMIT_P6 = -0.034932732504183661;
+static const double LIMIT_P7 = 0.083677044405899875;
+
+// written without branches to map to vector code, the kernels evaluate the same operations in the same order,
+// P is evaluated by the Estrin scheme for a short dependency chain
+static inline double limit(double value) {
+    double amplitude = fabs(value);
+    double u = amplitude - compressionStart;
+    u = (u > 0.0) ? u : 0.0;
+    u = (u < LIMIT_RANGE) ? u : LIMIT_RANGE;
+    double s = u / (u + 2.0);
+    double t = s * s;
+    double t2 = t * t;
+    double p = ((LIMIT_P0 + LIMIT_P1 * t) + t2 * (LIMIT_P2 + LIMIT_P3 * t))
+        + (t2 * t2) * ((LIMIT_P4 + LIMIT_P5 * t) + t2 * (LIMIT_P6 + LIMIT_P7 * t));
+    double knee = (amplitude < compressionStart) ? amplitude : compressionStart;
+    amplitude = knee + s * p;
+    amplitude = (amplitude < MAX_LEVEL) ? amplitude : MAX_LEVEL;
+    return copysign(amplitude, value);
 }
 
-void calcWindowAmplification(struct Window* window, double loudness, const int IS_LEVELER, const double input_gain) {
-    window->oldLoudness = window->loudness;
-    window->loudness = loudness;
-
-    window->oldAmplification = window->amplification;
-    const int IS_LIMITER = !IS_LEVELER;
-
-    if (window->loudness < MIN_LOUDNESS || (IS_LIMITER && window->loudness <= TARGET_LOUDNESS)) {
-        // Compensate 3dB if leveler is gated or limiter is idle
-        window->amplification = DB3 * 1.0 / input_gain;
-        return;
-    } else {
-        // Active Leveling/Limiting
-        window->amplification = getAmplification(window->loudness, window->oldLoudness, window->amplification);
-    }
-    // Constraints (Slew Rate / Max Change)
-    double maxAllowed = window->oldAmplification + window->maxAmpChange;
-    if (window->amplification > maxAllowed) {
-        window->amplification = maxAllowed;
-    }
-    // Hard Ceiling for Limiter mode
-    if (IS_LIMITER && window->amplification > 1.0 ) {
-        window->amplification = 1.0;
-    }
-}
+void calcWindowAmplification(struct Window* window, double loudness, const int IS_LEVELER, const double input_gain);
 
-void printWindow(struct Window* window, int isLast) {
-    fprintf(stderr, "%.1f\t%2.3f\t%2.3f\t%2.3f", window->position, window->loudness, (TARGET_LOUDNESS - window->loudness), window->amplification);
-    if (isLast) {
-        fprintf(stderr, "\n");
-    } else {
-        fprintf(stderr, "  ");
-    }
-}
+void printWindow(struct Window* window, int isLast);
 
 #endif
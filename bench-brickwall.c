@@ -0,0 +1,130 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+// Validation of the true peak limiter stage.
+//
+// Feeds signals with inter-sample overs through the true peak variants at several
+// input gains and measures the true peak of the output with the BS.1770 meter of
+// the true peak monitors, after the look ahead and the first adjust periods.
+// Prints the true and the sample peak of the output in dB and the cost per frame.
+// Exits with 1 if the true peak of the output is above the ceiling.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <ladspa.h>
+#include "brickwall.h"
+#include "true-peak.h"
+
+#define RATE 48000
+#define BLOCK 1024
+#define SECONDS 30
+// frames not measured, the look ahead and the first adjust periods
+#define SETTLE (8 * RATE)
+
+struct TestSignal {
+    const char* name;
+    // frequency and phase of the tone, a tone at rate / 4 and 45 degrees puts the samples 3dB below the true peak
+    double frequency;
+    double phase;
+    double level;
+    // bursts of the tone over a quiet bed, 0 = continuous
+    double burst;
+    double period;
+};
+
+static const struct TestSignal signals[] = {
+    {"11kHz bursts",      11025.0, 0.785, 0.9,  0.010, 0.5},
+    {"12kHz 45deg",       12000.0, 0.785, 0.5,  0.0,   0.0},
+    {"12kHz 45deg bursts", 12000.0, 0.785, 1.0, 0.002, 0.25},
+    {"3kHz and noise",     3000.0, 0.0,   0.6,  0.100, 0.4},
+};
+
+static const char* variants[] = {"rms_leveler_3s_true_peak", "rms_limiter_6s_true_peak"};
+static const float gains[] = {0.0f, 12.0f};
+
+const LADSPA_Descriptor* ladspa_descriptor(unsigned long i);
+
+static const LADSPA_Descriptor* findVariant(const char* label) {
+    const LADSPA_Descriptor* d;
+    for (unsigned long i = 0; (d = ladspa_descriptor(i)) != NULL; i++)
+        if (strcmp(d->Label, label) == 0) return d;
+    return NULL;
+}
+
+// both channels at frame n, the right one a fifth lower and with the noise inverted
+static void fillSignal(const struct TestSignal* signal, unsigned long n, unsigned int* seed, LADSPA_Data* left, LADSPA_Data* right) {
+    double t = (double) n / RATE;
+    *seed = *seed * 1664525u + 1013904223u;
+    double noise = (double) (*seed >> 8) / (1 << 24) - 0.5;
+    double envelope = 1.0;
+    if (signal->burst > 0) envelope = (fmod(t, signal->period) < signal->burst) ? 1.0 : 0.05;
+    double level = envelope * signal->level;
+    *left = (LADSPA_Data) (level * sin(2 * M_PI * signal->frequency * t + signal->phase) + 0.2 * envelope * noise);
+    *right = (LADSPA_Data) (level * sin(2 * M_PI * signal->frequency * 2.0 / 3.0 * t + signal->phase) - 0.2 * envelope * noise);
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int validate(const LADSPA_Descriptor* d, const struct TestSignal* signal, LADSPA_Data gain) {
+    LADSPA_Handle h = d->instantiate(d, RATE);
+    if (h == NULL) return 0;
+    LADSPA_Data in[2][BLOCK], out[2][BLOCK], latency = 0;
+    d->connect_port(h, 0, in[0]);
+    d->connect_port(h, 1, in[1]);
+    d->connect_port(h, 2, out[0]);
+    d->connect_port(h, 3, out[1]);
+    d->connect_port(h, 4, &gain);
+    d->connect_port(h, 5, &latency);
+
+    struct TruePeak meter;
+    initTruePeak(&meter);
+    double samplePeak = 0.0;
+    double elapsed = 0.0;
+    unsigned int seed = 1;
+    unsigned long frames = (unsigned long) SECONDS * RATE / BLOCK * BLOCK;
+    for (unsigned long n = 0; n < frames; n += BLOCK) {
+        for (int i = 0; i < BLOCK; i++)
+            fillSignal(signal, n + i, &seed, &in[0][i], &in[1][i]);
+        double start = now();
+        d->run(h, BLOCK);
+        elapsed += now() - start;
+        addTruePeak(&meter, out[0], out[1], BLOCK);
+        if (n < SETTLE) {
+            double left, right;
+            readTruePeak(&meter, &left, &right);
+            continue;
+        }
+        for (int c = 0; c < 2; c++)
+            for (int i = 0; i < BLOCK; i++)
+                if (fabs(out[c][i]) > samplePeak) samplePeak = fabs(out[c][i]);
+    }
+    d->cleanup(h);
+
+    double left, right;
+    readTruePeak(&meter, &left, &right);
+    double truePeak = (left > right) ? left : right;
+    int passed = truePeak <= BRICKWALL_CEILING;
+    printf("%-26s %-20s %+5.1fdB %8.3f dBTP %8.3f dBFS %6.2f ns/frame  %s\n", d->Label, signal->name, gain,
+        20.0 * log10(truePeak), 20.0 * log10(samplePeak), elapsed * 1e9 / frames, passed ? "ok" : "FAILED");
+    return passed;
+}
+
+int main(void) {
+    int passed = 1;
+    printf("ceiling %.3f dBTP\n", 20.0 * log10(BRICKWALL_CEILING));
+    for (int v = 0; v < (int) (sizeof(variants) / sizeof(variants[0])); v++) {
+        const LADSPA_Descriptor* d = findVariant(variants[v]);
+        if (d == NULL) return 1;
+        for (int s = 0; s < (int) (sizeof(signals) / sizeof(signals[0])); s++)
+            for (int g = 0; g < (int) (sizeof(gains) / sizeof(gains[0])); g++)
+                passed &= validate(d, &signals[s], gains[g]);
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,281 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+// Stand-in LADSPA host measuring the latency of each run() callback.
+//
+// Loads a plugin by dlopen, feeds program audio in blocks and waits for the
+// deadline of each block like a sound card callback would. Per block size it
+// prints percentiles of the callback duration, the worst-case jitter
+// (maximum - median), the latest wake up, the realtime factor (processing
+// time / audio time) and the number of callbacks over their period. The
+// slowest callbacks are listed with their stream time, so periodic spikes
+// like adjust points or monitor reports can be told apart from noise.
+//
+// usage: bench-host [-r rate] [-b blocks] [-s seconds] [-g gain] [-i file] [-p priority] [-n] plugin.so label
+//   -b  comma separated block sizes, default 64,256,1024,4096
+//   -i  interleaved stereo float32 input at the given rate, looped, default generated program audio
+//   -p  run with SCHED_FIFO at the given priority
+//   -n  do not wait for the deadlines, run as fast as possible
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+#include <sched.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <sys/mman.h>
+#include <ladspa.h>
+
+#define MAX_BLOCKS 16
+#define WORST_CALLBACKS 8
+
+struct Callback {
+    double duration;
+    double position;
+};
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void sleepUntil(double ns) {
+    struct timespec ts = { .tv_sec = (time_t) (ns / 1e9) };
+    ts.tv_nsec = (long) (ns - ts.tv_sec * 1e9);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
+static int compareDuration(const void* a, const void* b) {
+    double da = ((const struct Callback*) a)->duration;
+    double db = ((const struct Callback*) b)->duration;
+    return (da > db) - (da < db);
+}
+
+// program audio: speech like syllables with pauses, music bed and noise floor, louder and quieter passages
+static void generateAudio(LADSPA_Data* left, LADSPA_Data* right, unsigned long frames, unsigned long rate) {
+    unsigned int seed = 1;
+    for (unsigned long i = 0; i < frames; i++) {
+        double t = (double) i / rate;
+        seed = seed * 1664525u + 1013904223u;
+        double noise = (double) (seed >> 8) / (1 << 24) - 0.5;
+        double syllables = fmax(0.0, sin(2 * M_PI * 4.0 * t)) * (fmod(t, 7.0) < 5.5 ? 1.0 : 0.0);
+        double passage = (fmod(t, 40.0) < 20.0) ? 0.3 : 0.08;
+        double voice = syllables * sin(2 * M_PI * (180.0 + 40.0 * sin(2 * M_PI * 0.5 * t)) * t);
+        double music = 0.3 * sin(2 * M_PI * 110.0 * t) + 0.2 * sin(2 * M_PI * 330.0 * t + 0.5);
+        left[i] = (LADSPA_Data) (passage * (voice + music) + 0.002 * noise);
+        right[i] = (LADSPA_Data) (passage * (voice + 0.8 * music) - 0.002 * noise);
+    }
+}
+
+static unsigned long readAudio(const char* path, LADSPA_Data** left, LADSPA_Data** right) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return 0;
+    fseek(file, 0, SEEK_END);
+    unsigned long frames = ftell(file) / (2 * sizeof(float));
+    fseek(file, 0, SEEK_SET);
+    *left = malloc(frames * sizeof(LADSPA_Data));
+    *right = malloc(frames * sizeof(LADSPA_Data));
+    float frame[2];
+    for (unsigned long i = 0; *left != NULL && *right != NULL && i < frames; i++) {
+        if (fread(frame, sizeof(float), 2, file) != 2) {
+            frames = i;
+            break;
+        }
+        (*left)[i] = frame[0];
+        (*right)[i] = frame[1];
+    }
+    fclose(file);
+    return (*left == NULL || *right == NULL) ? 0 : frames;
+}
+
+static const LADSPA_Descriptor* findPlugin(const char* path, const char* label) {
+    void* library = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (library == NULL) {
+        fprintf(stderr, "%s\n", dlerror());
+        return NULL;
+    }
+    LADSPA_Descriptor_Function descriptor = (LADSPA_Descriptor_Function) dlsym(library, "ladspa_descriptor");
+    if (descriptor == NULL) {
+        fprintf(stderr, "%s: no ladspa_descriptor\n", path);
+        return NULL;
+    }
+    const LADSPA_Descriptor* d;
+    for (unsigned long i = 0; (d = descriptor(i)) != NULL; i++)
+        if (strcmp(d->Label, label) == 0) return d;
+    fprintf(stderr, "%s: no plugin %s\n", path, label);
+    return NULL;
+}
+
+// connect all ports, audio ports by direction, control inputs to their default,
+// channels beyond the first two of multichannel variants get the left and right input in turn
+static void connectPorts(const LADSPA_Descriptor* d, LADSPA_Handle h, LADSPA_Data* in[2], LADSPA_Data* out[2],
+        LADSPA_Data* controls, LADSPA_Data gain) {
+    int inputs = 0;
+    int outputs = 0;
+    for (unsigned long p = 0; p < d->PortCount; p++) {
+        LADSPA_PortDescriptor port = d->PortDescriptors[p];
+        if (LADSPA_IS_PORT_AUDIO(port)) {
+            if (LADSPA_IS_PORT_INPUT(port)) d->connect_port(h, p, in[inputs++ % 2]);
+            else d->connect_port(h, p, out[outputs++ % 2]);
+            continue;
+        }
+        const LADSPA_PortRangeHint* hint = &d->PortRangeHints[p];
+        controls[p] = 0.0;
+        if (LADSPA_IS_HINT_DEFAULT_1(hint->HintDescriptor)) controls[p] = 1.0;
+        if (LADSPA_IS_HINT_DEFAULT_MINIMUM(hint->HintDescriptor)) controls[p] = hint->LowerBound;
+        if (LADSPA_IS_HINT_DEFAULT_MAXIMUM(hint->HintDescriptor)) controls[p] = hint->UpperBound;
+        if (strcmp(d->PortNames[p], "Input Gain") == 0) controls[p] = gain;
+        d->connect_port(h, p, &controls[p]);
+    }
+}
+
+static int measure(const LADSPA_Descriptor* d, unsigned long rate, unsigned long block, double seconds,
+        const LADSPA_Data* left, const LADSPA_Data* right, unsigned long frames, LADSPA_Data gain, int realtime) {
+    const unsigned long callbacks = (unsigned long) (seconds * rate) / block;
+    struct Callback* callback = calloc(callbacks, sizeof(struct Callback));
+    LADSPA_Data* buffer = calloc(4 * block, sizeof(LADSPA_Data));
+    LADSPA_Data* controls = calloc(d->PortCount, sizeof(LADSPA_Data));
+    LADSPA_Handle h = d->instantiate(d, rate);
+    if (callback == NULL || buffer == NULL || controls == NULL || h == NULL || callbacks == 0) {
+        fprintf(stderr, "%s: cannot run %lu frame blocks\n", d->Label, block);
+        if (h != NULL) d->cleanup(h);
+        free(callback);
+        free(buffer);
+        free(controls);
+        return 0;
+    }
+    LADSPA_Data* in[2] = {buffer, buffer + block};
+    LADSPA_Data* out[2] = {buffer + 2 * block, buffer + 3 * block};
+    connectPorts(d, h, in, out, controls, gain);
+    if (d->activate != NULL) d->activate(h);
+
+    const double period = 1e9 * block / rate;
+    double lateWake = 0.0;
+    double busy = 0.0;
+    unsigned long misses = 0;
+    unsigned long position = 0;
+    double deadline = now() + period;
+    for (unsigned long c = 0; c < callbacks; c++) {
+        // the sound card hands over the next block
+        for (unsigned long i = 0; i < block; i++) {
+            in[0][i] = left[position];
+            in[1][i] = right[position];
+            if (++position >= frames) position = 0;
+        }
+        double start = now();
+        d->run(h, block);
+        double end = now();
+        callback[c].duration = end - start;
+        callback[c].position = (double) c * block / rate;
+        busy += callback[c].duration;
+        if (callback[c].duration > period) misses++;
+        if (!realtime) continue;
+        if (end > deadline) {
+            // overrun, restart the clock like a host after an xrun
+            deadline = end + period;
+            continue;
+        }
+        sleepUntil(deadline);
+        double late = now() - deadline;
+        if (late > lateWake) lateWake = late;
+        deadline += period;
+    }
+    if (d->deactivate != NULL) d->deactivate(h);
+    d->cleanup(h);
+
+    struct Callback* sorted = malloc(callbacks * sizeof(struct Callback));
+    if (sorted != NULL) {
+        memcpy(sorted, callback, callbacks * sizeof(struct Callback));
+        qsort(sorted, callbacks, sizeof(struct Callback), compareDuration);
+        double p50 = sorted[callbacks / 2].duration;
+        double max = sorted[callbacks - 1].duration;
+        printf("%-24s %6lu %5lu %8lu %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f %9.4f %6lu\n", d->Label, rate, block,
+            callbacks, p50 / 1e3, sorted[callbacks * 9 / 10].duration / 1e3, sorted[callbacks * 99 / 100].duration / 1e3,
+            sorted[callbacks * 999 / 1000].duration / 1e3, max / 1e3, (max - p50) / 1e3, lateWake / 1e3,
+            busy / (callbacks * period), misses);
+        printf("    slowest callbacks at");
+        for (unsigned long w = 0; w < WORST_CALLBACKS && w < callbacks; w++) {
+            const struct Callback* worst = &sorted[callbacks - 1 - w];
+            printf(" %.3fs (%.1fus)", worst->position, worst->duration / 1e3);
+        }
+        printf("\n");
+        fflush(stdout);
+        free(sorted);
+    }
+    free(callback);
+    free(buffer);
+    free(controls);
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    unsigned long rate = 48000;
+    unsigned long blocks[MAX_BLOCKS] = {64, 256, 1024, 4096};
+    int blockCount = 4;
+    double seconds = 10.0;
+    LADSPA_Data gain = 0.0;
+    const char* input = NULL;
+    int priority = 0;
+    int realtime = 1;
+    int option;
+    while ((option = getopt(argc, argv, "r:b:s:g:i:p:n")) != -1) {
+        switch (option) {
+        case 'r': rate = strtoul(optarg, NULL, 10); break;
+        case 'b':
+            blockCount = 0;
+            for (char* size = strtok(optarg, ","); size != NULL && blockCount < MAX_BLOCKS; size = strtok(NULL, ","))
+                blocks[blockCount++] = strtoul(size, NULL, 10);
+            break;
+        case 's': seconds = atof(optarg); break;
+        case 'g': gain = atof(optarg); break;
+        case 'i': input = optarg; break;
+        case 'p': priority = atoi(optarg); break;
+        case 'n': realtime = 0; break;
+        default: return 2;
+        }
+    }
+    if (argc - optind != 2 || rate == 0 || seconds <= 0) {
+        fprintf(stderr, "usage: %s [-r rate] [-b blocks] [-s seconds] [-g gain] [-i file] [-p priority] [-n] plugin.so label\n",
+            argv[0]);
+        return 2;
+    }
+    const LADSPA_Descriptor* d = findPlugin(argv[optind], argv[optind + 1]);
+    if (d == NULL) return 1;
+
+    LADSPA_Data* left = NULL;
+    LADSPA_Data* right = NULL;
+    unsigned long frames;
+    if (input != NULL) {
+        frames = readAudio(input, &left, &right);
+        if (frames == 0) {
+            fprintf(stderr, "%s: cannot read stereo float32 audio\n", input);
+            return 1;
+        }
+    } else {
+        frames = 60 * rate;
+        left = malloc(frames * sizeof(LADSPA_Data));
+        right = malloc(frames * sizeof(LADSPA_Data));
+        if (left == NULL || right == NULL) return 1;
+        generateAudio(left, right, frames, rate);
+    }
+
+    if (priority > 0) {
+        struct sched_param param = { .sched_priority = priority };
+        if (sched_setscheduler(0, SCHED_FIFO, &param) != 0) perror("sched_setscheduler");
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) perror("mlockall");
+    }
+
+    printf("%-24s %6s %5s %8s %9s %9s %9s %9s %9s %9s %9s %9s %6s\n", "plugin", "rate", "block", "calls",
+        "p50_us", "p90_us", "p99_us", "p99.9_us", "max_us", "jitter_us", "wake_us", "rt_factor", "misses");
+    int ok = 1;
+    for (int b = 0; b < blockCount; b++)
+        ok &= measure(d, rate, blocks[b], seconds, left, right, frames, gain, realtime);
+    free(left);
+    free(right);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,242 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+// Benchmark suite of the DSP primitives and of run() of all variants.
+//
+// Prints one CSV line per measurement: benchmark, variant, rate, block, window, ns_per_sample.
+// For run() a sample is one sample of one channel, so a stereo frame counts twice and a 5.1 frame six times.
+// Columns that do not apply to a benchmark are empty. The best of BENCH_REPEATS runs is reported.
+//
+// usage: bench-leveler [label...]    only run() of the given variants
+// BENCH_SECONDS sets the seconds of audio per run() measurement (default 4),
+// monitor logs are written to a temporary directory which is removed afterwards.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <ladspa.h>
+#include "amplify.h"
+#include "plugins.h"
+
+#define BENCH_REPEATS 3
+#define PRIMITIVE_SAMPLES 1000000
+
+static const unsigned long rates[] = {44100, 48000, 96000};
+static const double windows[] = {0.3, 1.0, 3.0, 6.0, 60.0};
+static const unsigned long blocks[] = {64, 256, 1024, 4096};
+
+static volatile double sink;
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// program material with peaks around -3dB and a noise floor, deterministic
+static void fillMaterial(LADSPA_Data* in, unsigned long n, unsigned long rate, unsigned int seed) {
+    for (unsigned long i = 0; i < n; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        double noise = (double) (seed >> 8) / (1 << 24) - 0.5;
+        double t = (double) i / rate;
+        double envelope = 0.5 + 0.5 * sin(2 * M_PI * 0.7 * t);
+        in[i] = (LADSPA_Data) (0.75 * (envelope * sin(2 * M_PI * 440.0 * t) + 0.1 * noise));
+    }
+}
+
+static void report(const char* benchmark, const char* variant, unsigned long rate, unsigned long block,
+        double window, double ns) {
+    printf("%s,%s,", benchmark, variant);
+    if (rate > 0) printf("%lu", rate);
+    printf(",");
+    if (block > 0) printf("%lu", block);
+    printf(",");
+    if (window > 0) printf("%g", window);
+    printf(",%.3f\n", ns);
+    fflush(stdout);
+}
+
+static void benchLimit(const LADSPA_Data* in) {
+    double best = INFINITY;
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        double sum = 0.0;
+        double start = now();
+        for (unsigned long i = 0; i < PRIMITIVE_SAMPLES; i++) sum += limit(2.0 * in[i]);
+        double time = now() - start;
+        sink = sum;
+        if (time < best) best = time;
+    }
+    report("limit", "", 0, 0, 0, best / PRIMITIVE_SAMPLES);
+}
+
+static void benchGetAmplification(const LADSPA_Data* in) {
+    double best = INFINITY;
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        double amp = 1.0;
+        double loudness = -30.0;
+        double start = now();
+        for (unsigned long i = 0; i < PRIMITIVE_SAMPLES; i++) {
+            double oldLoudness = loudness;
+            loudness = -30.0 + 20.0 * in[i];
+            amp = getAmplification(TARGET_LOUDNESS, loudness, oldLoudness, amp);
+        }
+        double time = now() - start;
+        sink = amp;
+        if (time < best) best = time;
+    }
+    report("getAmplification", "", 0, 0, 0, best / PRIMITIVE_SAMPLES);
+}
+
+static void benchInterpolateAmplification(unsigned long rate) {
+    struct Window window = {0};
+    if (!initWindow(&window, 0, 1.0, rate, MAX_CHANGE, ADJUST_RATE)) return;
+    double best = INFINITY;
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        double sum = 0.0;
+        double start = now();
+        for (unsigned long i = 0; i < PRIMITIVE_SAMPLES; i++) {
+            sum += interpolateAmplification(&window, 1.5, 0.5);
+            if (++window.adjustPosition >= window.adjustRate) window.adjustPosition = 0;
+        }
+        double time = now() - start;
+        sink = sum;
+        if (time < best) best = time;
+    }
+    freeWindow(&window);
+    report("interpolateAmplification", "", rate, 0, 0, best / PRIMITIVE_SAMPLES);
+}
+
+// per sample ring and power operations of a look ahead window, as used by the scalar run loops
+static void benchWindow(const LADSPA_Data* in, unsigned long rate, double duration) {
+    struct Window window = {0};
+    if (!initWindow(&window, 1, duration, rate, MAX_CHANGE, ADJUST_RATE)) return;
+    double best = INFINITY;
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        double sum = 0.0;
+        double start = now();
+        for (unsigned long i = 0; i < PRIMITIVE_SAMPLES; i++) {
+            prepareWindow(&window);
+            addWindowData(&window, in[i]);
+            sumWindowData(&window, in[i]);
+            sum += window.data[window.playPosition] - getWindowDcOffset(&window);
+            moveWindow(&window);
+        }
+        double time = now() - start;
+        sink = sum;
+        if (time < best) best = time;
+    }
+    freeWindow(&window);
+    report("window", "", rate, 0, duration, best / PRIMITIVE_SAMPLES);
+}
+
+static void benchRun(const LADSPA_Descriptor* d, unsigned long rate, unsigned long block, double seconds) {
+    const struct PluginConfig* config = (const struct PluginConfig*) d->ImplementationData;
+    const unsigned long frames = (unsigned long) (seconds * rate) / block * block;
+    // audio ports in the order of the descriptor, inputs before outputs
+    unsigned long channels = 0;
+    for (unsigned long p = 0; p < d->PortCount; p++)
+        if (LADSPA_IS_PORT_AUDIO(d->PortDescriptors[p]) && LADSPA_IS_PORT_INPUT(d->PortDescriptors[p])) channels++;
+    LADSPA_Data* in = malloc(channels * frames * sizeof(LADSPA_Data));
+    LADSPA_Data* out = malloc(channels * block * sizeof(LADSPA_Data));
+    if (channels == 0 || in == NULL || out == NULL) {
+        free(in);
+        free(out);
+        return;
+    }
+    for (unsigned long c = 0; c < channels; c++)
+        fillMaterial(in + c * frames, frames, rate, c + 1);
+
+    double best = INFINITY;
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        LADSPA_Handle h = d->instantiate(d, rate);
+        if (h == NULL) break;
+        LADSPA_Data gain = 0.0;
+        LADSPA_Data latency = 0.0;
+        unsigned long outputs = 0;
+        for (unsigned long p = 0; p < d->PortCount; p++) {
+            LADSPA_PortDescriptor port = d->PortDescriptors[p];
+            if (LADSPA_IS_PORT_AUDIO(port) && LADSPA_IS_PORT_OUTPUT(port)) d->connect_port(h, p, out + block * outputs++);
+            if (strcmp(d->PortNames[p], "Input Gain") == 0) d->connect_port(h, p, &gain);
+            if (strcmp(d->PortNames[p], "latency") == 0) d->connect_port(h, p, &latency);
+        }
+        double start = now();
+        for (unsigned long s = 0; s < frames; s += block) {
+            unsigned long inputs = 0;
+            for (unsigned long p = 0; p < d->PortCount; p++) {
+                LADSPA_PortDescriptor port = d->PortDescriptors[p];
+                if (LADSPA_IS_PORT_AUDIO(port) && LADSPA_IS_PORT_INPUT(port)) d->connect_port(h, p, in + frames * inputs++ + s);
+            }
+            d->run(h, block);
+        }
+        double time = now() - start;
+        d->cleanup(h);
+        sink = out[0];
+        if (time < best) best = time;
+    }
+    free(in);
+    free(out);
+    if (best < INFINITY) report("run", d->Label, rate, block, config->bufferDuration[0], best / (channels * frames));
+}
+
+static int selected(const char* label, int argc, char** argv) {
+    if (argc < 2) return 1;
+    for (int a = 1; a < argc; a++)
+        if (strcmp(argv[a], label) == 0) return 1;
+    return 0;
+}
+
+static void removeDirectory(const char* path) {
+    DIR* dir = opendir(path);
+    if (dir == NULL) return;
+    struct dirent* entry;
+    char file[512];
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+        snprintf(file, sizeof(file), "%s/%s", path, entry->d_name);
+        unlink(file);
+    }
+    closedir(dir);
+    rmdir(path);
+}
+
+int main(int argc, char** argv) {
+    const char* secondsEnv = getenv("BENCH_SECONDS");
+    double seconds = (secondsEnv != NULL) ? atof(secondsEnv) : 4.0;
+    if (seconds <= 0) seconds = 4.0;
+
+    char logDir[] = "/tmp/bench-leveler-XXXXXX";
+    if (mkdtemp(logDir) == NULL) {
+        perror("mkdtemp");
+        return 1;
+    }
+    setenv("MONITOR_LOG_DIR", logDir, 1);
+
+    printf("benchmark,variant,rate,block,window,ns_per_sample\n");
+    if (argc < 2) {
+        LADSPA_Data* in = malloc(PRIMITIVE_SAMPLES * sizeof(LADSPA_Data));
+        if (in == NULL) return 1;
+        fillMaterial(in, PRIMITIVE_SAMPLES, 48000, 1);
+        benchLimit(in);
+        benchGetAmplification(in);
+        for (int r = 0; r < ARRAY_LENGTH(rates); r++)
+            benchInterpolateAmplification(rates[r]);
+        for (int r = 0; r < ARRAY_LENGTH(rates); r++)
+            for (int w = 0; w < ARRAY_LENGTH(windows); w++)
+                benchWindow(in, rates[r], windows[w]);
+        free(in);
+    }
+
+    const LADSPA_Descriptor* d;
+    for (unsigned long i = 0; (d = ladspa_descriptor(i)) != NULL; i++) {
+        if (!selected(d->Label, argc, argv)) continue;
+        for (int r = 0; r < ARRAY_LENGTH(rates); r++)
+            for (int b = 0; b < ARRAY_LENGTH(blocks); b++)
+                benchRun(d, rates[r], blocks[b], seconds);
+    }
+    removeDirectory(logDir);
+    return 0;
+}
@@ -0,0 +1,119 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+// Benchmark of limit() against the logarithmic curve it approximates.
+//
+// Prints the maximum error of the approximation and the cost per sample of the
+// logarithm, the scalar limit() and the block kernel of the instruction set
+// selected by LEVELER_SIMD, for silent, typical and hot program material.
+// Cost is counted in TSC cycles on x86, in nanoseconds elsewhere.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <ladspa.h>
+#include "kernel.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define SAMPLES 4096
+#define ROUNDS 2000
+
+// the previous limit(), compress by logarithm
+static double limitLog(double value) {
+    double amplitude = fabs(value);
+    if (amplitude > compressionStart)
+        amplitude = compressionStart + (1.0 - compressionStart) * log10(amplitude - compressionStart + 1.0);
+    if (amplitude > MAX_LEVEL) amplitude = MAX_LEVEL;
+    return copysign(amplitude, value);
+}
+
+static unsigned long long now(const char** unit) {
+#if defined(__x86_64__) || defined(__i386__)
+    *unit = "cycles";
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    *unit = "ns";
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+// program material at a given peak level with a noise floor, deterministic
+static void fillMaterial(double* in, double peak, unsigned int seed) {
+    for (int i = 0; i < SAMPLES; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        double noise = (double) (seed >> 8) / (1 << 24) - 0.5;
+        double envelope = 0.5 + 0.5 * sin(2 * M_PI * i / 1500.0);
+        in[i] = peak * (envelope * sin(2 * M_PI * i / 48.0) + 0.1 * noise);
+    }
+}
+
+static volatile LADSPA_Data sink;
+
+static void measure(const char* material, const double* in) {
+    static LADSPA_Data out[SAMPLES];
+    const char* unit;
+    LimitKernel kernel = getLimitKernel();
+    double cost[3];
+    for (int m = 0; m < 3; m++) {
+        unsigned long long best = ~0ULL;
+        for (int r = 0; r < ROUNDS; r++) {
+            unsigned long long start = now(&unit);
+            if (m == 0) for (int i = 0; i < SAMPLES; i++) out[i] = (LADSPA_Data) limitLog(in[i]);
+            if (m == 1) for (int i = 0; i < SAMPLES; i++) out[i] = (LADSPA_Data) limit(in[i]);
+            if (m == 2) kernel(in, out, SAMPLES);
+            unsigned long long time = now(&unit) - start;
+            if (time < best) best = time;
+            sink = out[r % SAMPLES];
+        }
+        cost[m] = (double) best / SAMPLES;
+    }
+    const char* simd = getenv("LEVELER_SIMD");
+    printf("%-8s %s/sample  log %6.2f  limit %6.2f  block(%s) %6.2f\n", material, unit, cost[0], cost[1],
+        simd == NULL ? "auto" : simd, cost[2]);
+}
+
+int main() {
+    // error of the approximation over the whole curve
+    double maxError = 0.0;
+    double errorAt = 0.0;
+    long rounded = 0;
+    const long steps = 10000000;
+    for (long i = 0; i <= steps; i++) {
+        double value = 5.0 * i / steps;
+        double error = fabs(limit(value) - limitLog(value));
+        if (error > maxError) {
+            maxError = error;
+            errorAt = value;
+        }
+        if ((LADSPA_Data) limit(value) != (LADSPA_Data) limitLog(value)) rounded++;
+    }
+    printf("max error %.3g at %.6f, %.3f%% of the samples round to another float\n", maxError, errorAt,
+        100.0 * rounded / (steps + 1));
+
+    // vector and scalar limit() have to match exactly
+    static double in[SAMPLES];
+    static LADSPA_Data out[SAMPLES];
+    fillMaterial(in, 2.0, 1);
+    getLimitKernel()(in, out, SAMPLES);
+    for (int i = 0; i < SAMPLES; i++) {
+        if (out[i] != (LADSPA_Data) limit(in[i])) {
+            printf("block kernel differs from limit() at %d: %.9g != %.9g\n", i, out[i], limit(in[i]));
+            return 1;
+        }
+    }
+
+    // silent: -60dB, typical: peaks around -3dB, hot: peaks at +6dB
+    fillMaterial(in, 0.001, 1);
+    measure("silent", in);
+    fillMaterial(in, 0.75, 2);
+    measure("typical", in);
+    fillMaterial(in, 2.0, 3);
+    measure("hot", in);
+    return 0;
+}
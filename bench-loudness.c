@@ -0,0 +1,161 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+// Validation and benchmark of the built-in K-weighting loudness engine.
+//
+// Feeds the stereo test signals of EBU Tech 3341 through the K-weighting filter
+// into a linked window and checks the loudness read with getWindowLufs() against
+// the expected values, then prints the cost per frame of the native engine and
+// of the libebur128 path of the per channel EBU R128 variants.
+// Exits with 1 if a test signal is off by more than 0.1 LU.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <ladspa.h>
+#include "ebur128.h"
+#include "amplify.h"
+#include "k-weighting.h"
+
+#define RATE 48000
+#define SPAN 1024
+#define TOLERANCE 0.1
+
+struct TestSignal {
+    const char* name;
+    // window in seconds, 0.4 = momentary, 3 = short-term
+    double window;
+    // alternating tone bursts of 1kHz, the second is left out if its duration is 0
+    double level1, duration1;
+    double level2, duration2;
+    double expected;
+};
+
+static const struct TestSignal signals[] = {
+    {"1kHz -23dBFS",          3.0, -23.0, 1.0,  -23.0, 0.0,  -23.0},
+    {"1kHz -33dBFS",          3.0, -33.0, 1.0,  -33.0, 0.0,  -33.0},
+    {"momentary bursts",      0.4, -20.0, 0.18, -30.0, 0.22, -23.0},
+    {"short-term bursts",     3.0, -20.0, 1.34, -30.0, 1.66, -23.0},
+};
+
+// sample of the 1kHz tone in both channels at frame n
+static LADSPA_Data tone(const struct TestSignal* signal, unsigned long n) {
+    double period = signal->duration1 + signal->duration2;
+    double t = (double) n / RATE;
+    double level = signal->level1;
+    if (signal->duration2 > 0 && fmod(t, period) >= signal->duration1) level = signal->level2;
+    return (LADSPA_Data) (pow(10.0, level / 20.0) * sin(2 * M_PI * 1000.0 * t));
+}
+
+// loudness of the window after 20 seconds of the signal, read at the end of a full period
+static int validate(const struct TestSignal* signal) {
+    struct Window window = {0};
+    struct KWeighting filter;
+    if (!initWindowChannels(&window, 2, 0, signal->window, RATE, MAX_CHANGE, ADJUST_RATE)) return 0;
+    initKWeighting(&filter, RATE);
+
+    double period = signal->duration2 > 0 ? signal->duration1 + signal->duration2 : 1.0;
+    unsigned long frames = (unsigned long) (ceil(20.0 / period) * period * RATE + 0.5);
+    for (unsigned long n = 0; n < frames; n++) {
+        LADSPA_Data value = tone(signal, n);
+        sumWindowPower(&window, filterKWeighting(&filter, value, value));
+        moveWindow(&window);
+    }
+    double loudness = getWindowLufs(&window);
+    freeWindow(&window);
+
+    int passed = fabs(loudness - signal->expected) <= TOLERANCE;
+    printf("%-20s %4.1fs %8.2f LUFS, expected %6.1f  %s\n",
+        signal->name, signal->window, loudness, signal->expected, passed ? "ok" : "FAILED");
+    return passed;
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static volatile double sink;
+
+// program material, deterministic
+static void fillMaterial(LADSPA_Data* left, LADSPA_Data* right, unsigned long frames) {
+    unsigned int seed = 1;
+    for (unsigned long i = 0; i < frames; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        double noise = (double) (seed >> 8) / (1 << 24) - 0.5;
+        double envelope = 0.5 + 0.5 * sin(2 * M_PI * i / 96000.0);
+        left[i] = (LADSPA_Data) (0.3 * envelope * sin(2 * M_PI * i / 48.0) + 0.05 * noise);
+        right[i] = (LADSPA_Data) (0.3 * envelope * sin(2 * M_PI * i / 110.0) - 0.05 * noise);
+    }
+}
+
+// filter and window of the linked variants
+static double benchNative(const LADSPA_Data* left, const LADSPA_Data* right, unsigned long frames, double duration) {
+    struct Window window = {0};
+    struct KWeighting filter;
+    if (!initWindowChannels(&window, 2, 0, duration, RATE, MAX_CHANGE, ADJUST_RATE)) return NAN;
+    initKWeighting(&filter, RATE);
+
+    double start = now();
+    for (unsigned long n = 0; n < frames; n++) {
+        sumWindowPower(&window, filterKWeighting(&filter, left[n], right[n]));
+        if (window.adjustPosition == 0) sink = getWindowLufs(&window);
+        moveWindow(&window);
+        if (n % SPAN == SPAN - 1) flushKWeighting(&filter);
+    }
+    double elapsed = now() - start;
+    freeWindow(&window);
+    return elapsed * 1e9 / frames;
+}
+
+// one libebur128 state per channel fed in spans, read at each adjust point as the per channel variants do
+static double benchLibebur128(const LADSPA_Data* left, const LADSPA_Data* right, unsigned long frames, double duration) {
+    const LADSPA_Data* input[] = {left, right};
+    ebur128_state* states[2];
+    unsigned long adjust = (unsigned long) (RATE * ADJUST_RATE);
+    double loudness;
+
+    double start = now();
+    for (int c = 0; c < 2; c++) {
+        states[c] = ebur128_init(1, RATE, EBUR128_MODE_M);
+        if (states[c] == NULL) return NAN;
+        ebur128_set_max_window(states[c], (unsigned long) (duration * 1000.0));
+    }
+    for (unsigned long n = 0; n < frames; n += adjust) {
+        unsigned long length = frames - n < adjust ? frames - n : adjust;
+        for (int c = 0; c < 2; c++) {
+            for (unsigned long s = 0; s < length; s += SPAN)
+                ebur128_add_frames_float(states[c], input[c] + n + s, length - s < SPAN ? length - s : SPAN);
+            ebur128_loudness_window(states[c], (unsigned long) (duration * 1000.0), &loudness);
+            sink = loudness;
+        }
+    }
+    double elapsed = now() - start;
+    for (int c = 0; c < 2; c++) ebur128_destroy(&states[c]);
+    return elapsed * 1e9 / frames;
+}
+
+int main(void) {
+    int passed = 1;
+    for (int i = 0; i < (int) (sizeof(signals) / sizeof(signals[0])); i++)
+        passed &= validate(&signals[i]);
+
+    double seconds = getenv("BENCH_SECONDS") ? atof(getenv("BENCH_SECONDS")) : 60.0;
+    unsigned long frames = (unsigned long) (seconds * RATE);
+    LADSPA_Data* left = malloc(frames * sizeof(LADSPA_Data));
+    LADSPA_Data* right = malloc(frames * sizeof(LADSPA_Data));
+    if (left == NULL || right == NULL) return 1;
+    fillMaterial(left, right, frames);
+
+    printf("\nengine,window,ns_per_frame\n");
+    double durations[] = {3.0, 6.0};
+    for (int i = 0; i < 2; i++) {
+        printf("native,%.0f,%.2f\n", durations[i], benchNative(left, right, frames, durations[i]));
+        printf("libebur128,%.0f,%.2f\n", durations[i], benchLibebur128(left, right, frames, durations[i]));
+    }
+    free(left);
+    free(right);
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "brickwall.h"
+
+int initBrickwall(struct Brickwall* brickwall, int channels, double lookAhead, double rate) {
+    memset(brickwall, 0, sizeof(*brickwall));
+    unsigned long frames = (unsigned long) (lookAhead * rate);
+    if (frames == 0 || channels < 1 || channels > 2) return 0;
+    brickwall->channels = channels;
+    // the gain ramps over the look ahead, the spans reach half of the filter beyond both ends of the ramp,
+    // and the oversampled peaks lie another half of the filter behind the frame entering
+    brickwall->attack = frames;
+    brickwall->delay = frames + TRUE_PEAK_TAPS;
+    brickwall->size = frames + TRUE_PEAK_TAPS + 1;
+    brickwall->peak = (double*) calloc(brickwall->size, sizeof(double));
+    brickwall->frame = (uint64_t*) calloc(brickwall->size, sizeof(uint64_t));
+    brickwall->target = (double*) calloc(brickwall->attack, sizeof(double));
+    if (brickwall->peak == NULL || brickwall->frame == NULL || brickwall->target == NULL) {
+        freeBrickwall(brickwall);
+        return 0;
+    }
+    brickwall->gain = 1.0;
+    brickwall->release = 1.0 - exp(-1.0 / (BRICKWALL_RELEASE * rate));
+    return 1;
+}
+
+void freeBrickwall(struct Brickwall* brickwall) {
+    free(brickwall->peak);
+    free(brickwall->frame);
+    free(brickwall->target);
+    brickwall->peak = NULL;
+    brickwall->frame = NULL;
+    brickwall->target = NULL;
+}
+
+double runBrickwall(struct Brickwall* brickwall, const LADSPA_Data* ahead, double amplification) {
+    double peak = 0.0;
+    for (int c = 0; c < brickwall->channels; c++) {
+        double sample = fabs(ahead[c]);
+        double truePeak = filterTruePeak(&brickwall->truePeak[c], brickwall->truePeakPosition, ahead[c]);
+        if (sample > peak) peak = sample;
+        if (truePeak > peak) peak = truePeak;
+    }
+    if (++brickwall->truePeakPosition == TRUE_PEAK_TAPS) brickwall->truePeakPosition = 0;
+
+    // drop the frame that left the span, then the smaller peaks before the new one
+    uint64_t position = brickwall->position++;
+    if (brickwall->count > 0 && brickwall->frame[brickwall->head] + brickwall->size <= position) {
+        if (++brickwall->head == brickwall->size) brickwall->head = 0;
+        brickwall->count--;
+    }
+    while (brickwall->count > 0) {
+        unsigned long back = brickwall->head + brickwall->count - 1;
+        if (back >= brickwall->size) back -= brickwall->size;
+        if (brickwall->peak[back] > peak) break;
+        brickwall->count--;
+    }
+    unsigned long tail = brickwall->head + brickwall->count;
+    if (tail >= brickwall->size) tail -= brickwall->size;
+    brickwall->peak[tail] = peak;
+    brickwall->frame[tail] = position;
+    brickwall->count++;
+
+    // largest gain of the span, at most the amplification
+    double maximum = brickwall->peak[brickwall->head];
+    double target = amplification;
+    if (maximum * amplification > BRICKWALL_TARGET) target = BRICKWALL_TARGET / maximum;
+
+    // mean over the attack frames, summed up again once per cycle, so rounding errors do not accumulate
+    brickwall->targetSum += target - brickwall->target[brickwall->index];
+    brickwall->target[brickwall->index] = target;
+    if (++brickwall->index == brickwall->attack) {
+        brickwall->index = 0;
+        brickwall->targetSum = 0.0;
+        for (unsigned long i = 0; i < brickwall->attack; i++)
+            brickwall->targetSum += brickwall->target[i];
+    }
+    double mean = brickwall->targetSum / brickwall->attack;
+
+    // follow the ramp down at once, release slower
+    if (mean < brickwall->gain) brickwall->gain = mean;
+    else brickwall->gain += (mean - brickwall->gain) * brickwall->release;
+    return brickwall->gain;
+}
@@ -0,0 +1,71 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef brickwall_h
+#define brickwall_h
+
+// Look ahead true peak limiter, the optional final stage of levelers and limiters.
+//
+// The stage keeps no audio of its own, it reads the frames ahead of the play
+// position from the look ahead ring of the window. Each frame entering its
+// look ahead is oversampled (see true-peak.h) and its true peak pushed into a
+// monotonic deque, which holds the falling maxima of the last span frames, so
+// the maximum is found in constant time per frame. The gain target / maximum
+// of each span is averaged over the attack frames: every span in that average
+// contains the peaks of the played frame and of its neighbours within the
+// filter, so the average is at most target / peak there and the gain ramps
+// linearly onto the target, reaching it exactly when the peak is played.
+// It is released more slowly. The returned gain caps the gain of the leveler,
+// clipping the played value at the ceiling is a safety net only.
+
+#include <stdint.h>
+#include <ladspa.h>
+#include "true-peak.h"
+
+// true peak ceiling, -1dBTP as MAX_LEVEL of limit()
+#define BRICKWALL_CEILING 0.891250938
+// level the gain aims at, 0.0001dB below the ceiling for the rounding of the float output and filter
+#define BRICKWALL_TARGET (BRICKWALL_CEILING * 0.99999)
+// release time in seconds
+#define BRICKWALL_RELEASE 0.05
+
+struct Brickwall {
+    int channels;
+    // frames from the played frame to the frame entering the look ahead
+    unsigned long delay;
+    // deque of the falling maxima of the last size frames, a ring of size entries
+    double* peak;
+    uint64_t* frame;
+    unsigned long size;
+    unsigned long head;
+    unsigned long count;
+    // number of the frame entering next
+    uint64_t position;
+    struct TruePeakChannel truePeak[2];
+    int truePeakPosition;
+    // ring of the gain targets of the last attack frames and their sum
+    double* target;
+    unsigned long attack;
+    unsigned long index;
+    double targetSum;
+    double gain;
+    double release;
+};
+
+// look ahead in seconds, 0 on failure
+int initBrickwall(struct Brickwall* brickwall, int channels, double lookAhead, double rate);
+void freeBrickwall(struct Brickwall* brickwall);
+
+// add the frame delay frames ahead of the played one, values per channel, returns the largest gain
+// of the played frame, amplification is the largest amplification expected ahead, the returned gain
+// stays below it, so the ramps start from there
+double runBrickwall(struct Brickwall* brickwall, const LADSPA_Data* ahead, double amplification);
+
+// clip a played value at the ceiling, only reached by rounding or a changing DC offset
+static inline double clipBrickwall(double value) {
+    if (value > BRICKWALL_CEILING) return BRICKWALL_CEILING;
+    if (value < -BRICKWALL_CEILING) return -BRICKWALL_CEILING;
+    return value;
+}
+
+#endif
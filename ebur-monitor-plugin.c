@@ -1,6 +1,3 @@
-#ifndef ebur_plugin
-#define ebur_plugin
-
 //  SPDX-FileCopyrightText: 2024 Milan Chrobok
 //  SPDX-License-Identifier: GPL-3.0-or-later
 
@@ -10,47 +7,77 @@
 #include <math.h>
 #include "ebur128.h"
 #include "amplify.h"
-#include "stereo-plugin.h"
+#include "plugins.h"
+#include "monitor-log.h"
+#include "meter.h"
+#include "gating.h"
 
-const double SECONDS = 1000.0;
-extern const double BUFFER_DURATION1;
-extern const char *LOG_ID;
+// the rolling integrated loudness covers the last DAY_HOURS hours, dropping an hour at a time
+#define DAY_HOURS 24
+#define HOUR_SECONDS 3600
 
 struct EburChannel {
     LADSPA_Data *in;
     LADSPA_Data *out;
     ebur128_state *ebur128;
+    // mean square of the last blocks, the newest at block
+    double blockPower[MONITOR_SHORT_TERM_BLOCKS];
+    int block;
+    // gating blocks of the report interval, since instantiation, of the last DAY_HOURS hours and per hour
+    struct GatingHistogram interval;
+    struct GatingHistogram start;
+    struct GatingHistogram day;
+    struct GatingHistogram hours[DAY_HOURS];
 };
 
 // define our handler type
 typedef struct {
+    const struct PluginConfig* config;
     struct EburChannel left;
     struct EburChannel right;
     unsigned long rate;
     double t;
-    char *log_dir;
+    // sample frames since instantiation
+    uint64_t samples;
+    // frames since the last block and number of completed blocks, up to MONITOR_SHORT_TERM_BLOCKS
+    unsigned long loudnessPosition;
+    int blocks;
+    // current hour of the rolling day and the hours of audio since instantiation
+    int hour;
+    uint64_t hours;
+    struct MonitorLog* log;
+    struct Meter* meter;
 } EburLeveler;
 
-static LADSPA_Handle instantiate(const LADSPA_Descriptor *d, unsigned long rate) {
+LADSPA_Handle ebur_monitor_instantiate(const LADSPA_Descriptor *d, unsigned long rate) {
     EburLeveler *h = calloc(1, sizeof(EburLeveler));
     if (h == NULL) return NULL;
+    h->config = (const struct PluginConfig*) d->ImplementationData;
     h->rate = rate;
-    h->log_dir = getenv("MONITOR_LOG_DIR");
-    if (h->log_dir == NULL)
-        h->log_dir = "/var/log/monitor";
-    h->left.ebur128 = ebur128_init(1, h->rate, EBUR128_MODE_I);
-    h->right.ebur128 = ebur128_init(1, h->rate, EBUR128_MODE_I);
+    // only the momentary window is taken from libebur128, it keeps no block history in this mode
+    h->left.ebur128 = ebur128_init(1, h->rate, EBUR128_MODE_M);
+    h->right.ebur128 = ebur128_init(1, h->rate, EBUR128_MODE_M);
+    h->log = openMonitorLog(h->config->logId, h->rate);
+    if (h->log == NULL) {
+        ebur128_destroy(&h->left.ebur128);
+        ebur128_destroy(&h->right.ebur128);
+        free(h);
+        return NULL;
+    }
+    h->meter = openMeter(d->Label, rate);
     return (LADSPA_Handle) h;
 }
 
-static void cleanup(LADSPA_Handle handle) {
+void ebur_monitor_cleanup(LADSPA_Handle handle) {
     EburLeveler *h = (EburLeveler*) handle;
     ebur128_destroy(&h->left.ebur128);
     ebur128_destroy(&h->right.ebur128);
+    closeMonitorLog(h->log);
+    closeMeter(h->meter);
     free(handle);
 }
 
-static void connect_port(const LADSPA_Handle handle, unsigned long num,
+void ebur_monitor_connect_port(const LADSPA_Handle handle, unsigned long num,
         LADSPA_Data *port) {
     EburLeveler *h = (EburLeveler*) handle;
     if (num == 0)
@@ -63,43 +90,108 @@ static void connect_port(const LADSPA_Handle handle, unsigned long num,
         h->right.out = port;
 }
 
-static void run(LADSPA_Handle handle, unsigned long samples) {
-    EburLeveler *h = (EburLeveler*) handle;
-    if (h == NULL || h->input_gain_port == NULL || samples == 0) return;
+static double getLufs(double power) {
+    if (power <= 0.0) return -HUGE_VAL;
+    return -0.691 + 10.0 * log10(power);
+}
+
+// mean square of the newest blocks
+static double getBlockPower(const struct EburChannel* channel, int blocks) {
+    double sum = 0.0;
+    for (int b = 0; b < blocks; b++)
+        sum += channel->blockPower[(channel->block + MONITOR_SHORT_TERM_BLOCKS - b) % MONITOR_SHORT_TERM_BLOCKS];
+    return sum / blocks;
+}
+
+// count a 400ms gating block, every 100ms as the blocks overlap by 75%
+static void addBlock(EburLeveler* h, struct EburChannel* channel, double power) {
+    addGatingBlock(&channel->interval, power);
+    addGatingBlock(&channel->start, power);
+    addGatingBlock(&channel->day, power);
+    addGatingBlock(&channel->hours[h->hour], power);
+}
+
+// drop the oldest hour from the rolling day
+static void nextHour(EburLeveler* h) {
+    struct EburChannel* channels[] = {&h->left, &h->right};
+    h->hour = (h->hour + 1) % DAY_HOURS;
+    for (int c = 0; c < ARRAY_LENGTH(channels); c++) {
+        subtractGatingHistogram(&channels[c]->day, &channels[c]->hours[h->hour]);
+        clearGatingHistogram(&channels[c]->hours[h->hour]);
+    }
+}
 
+// momentary and short-term loudness from the K-weighted power of each block
+static void updateLoudness(EburLeveler* h) {
     struct EburChannel* channels[] = {&h->left, &h->right};
+    double momentary[ARRAY_LENGTH(channels)];
+    double shortTerm[ARRAY_LENGTH(channels)];
+    // the hour of the audio of the block, from the frames since instantiation
+    uint64_t hours = (h->samples - 1) / ((uint64_t) HOUR_SECONDS * h->rate);
+    for (; h->hours < hours; h->hours++) nextHour(h);
+    if (h->blocks < MONITOR_SHORT_TERM_BLOCKS) h->blocks++;
     for (int c = 0; c < ARRAY_LENGTH(channels); c++) {
-        struct EburChannel *channel = channels[c];
-        if (channel->in == NULL || channel->out == NULL) continue;
-        for (uint32_t s = 0; s < samples; s++) {
-            LADSPA_Data input = (channel == NULL) ? 0 : channel->in[s];
-            if (channel->out != NULL)
-                channel->out[s] = input;
-            ebur128_add_frames_float(channel->ebur128, &input, (size_t) 1);
+        struct EburChannel* channel = channels[c];
+        double loudness = -HUGE_VAL;
+        ebur128_loudness_window(channel->ebur128, 1000 / MONITOR_LOUDNESS_RATE, &loudness);
+        channel->block = (channel->block + 1) % MONITOR_SHORT_TERM_BLOCKS;
+        channel->blockPower[channel->block] = (loudness == -HUGE_VAL) ? 0.0 : pow(10.0, (loudness + 0.691) / 10.0);
+        int momentaryBlocks = (h->blocks < MONITOR_MOMENTARY_BLOCKS) ? h->blocks : MONITOR_MOMENTARY_BLOCKS;
+        double power = getBlockPower(channel, momentaryBlocks);
+        if (momentaryBlocks == MONITOR_MOMENTARY_BLOCKS) addBlock(h, channel, power);
+        momentary[c] = getLufs(power);
+        shortTerm[c] = getLufs(getBlockPower(channel, h->blocks));
+    }
+    pushMonitorLog(h->log, MONITOR_MOMENTARY, h->samples, momentary[0], momentary[1]);
+    pushMonitorLog(h->log, MONITOR_SHORT_TERM, h->samples, shortTerm[0], shortTerm[1]);
+    if (h->meter != NULL) setMeterLoudness(h->meter, momentary, shortTerm);
+}
+
+void ebur_monitor_run(LADSPA_Handle handle, unsigned long samples) {
+    EburLeveler *h = (EburLeveler*) handle;
+    if (h == NULL || samples == 0) return;
+
+    // feed libebur128 in slices up to the next 100ms boundary, so each block measures exactly its own 100ms
+    // and blocks longer than that update the loudness at each boundary
+    struct EburChannel* channels[] = {&h->left, &h->right};
+    unsigned long interval = h->rate / MONITOR_LOUDNESS_RATE;
+    for (unsigned long s = 0; s < samples;) {
+        unsigned long end = s + interval - h->loudnessPosition;
+        if (end > samples) end = samples;
+        for (int c = 0; c < ARRAY_LENGTH(channels); c++) {
+            struct EburChannel *channel = channels[c];
+            if (channel->in == NULL || channel->out == NULL) continue;
+            ebur128_add_frames_float(channel->ebur128, channel->in + s, (size_t) (end - s));
+            for (unsigned long i = s; i < end; i++)
+                channel->out[i] = channel->in[i];
         }
+        h->samples += end - s;
+        h->loudnessPosition += end - s;
+        s = end;
+        if (h->loudnessPosition < interval) continue;
+        h->loudnessPosition = 0;
+        updateLoudness(h);
     }
 
     h->t += samples;
-    double limit = BUFFER_DURATION1 * h->rate;
+    if (h->meter != NULL && addMeterBlock(h->meter, h->left.out, h->right.out, samples))
+        publishMeter(h->meter, NAN, NAN, NAN, NAN);
+    double limit = h->config->bufferDuration[0] * h->rate;
     if (h->t > limit) {
         h->t -= limit;
-        double loudness_l = 0.;
-        double loudness_r = 0.;
+        double interval[ARRAY_LENGTH(channels)];
+        double start[ARRAY_LENGTH(channels)];
+        double day[ARRAY_LENGTH(channels)];
         for (int c = 0; c < ARRAY_LENGTH(channels); c++) {
             struct EburChannel *channel = channels[c];
-            double loudness = 0;
-            ebur128_loudness_global(channel->ebur128, &loudness);
-            if (c == 0)
-                loudness_l = loudness;
-            if (c == 1)
-                loudness_r = loudness;
-            ebur128_destroy(&channel->ebur128);
-            channel->ebur128 = ebur128_init(1, h->rate, EBUR128_MODE_I);
+            interval[c] = getGatedLoudness(&channel->interval);
+            start[c] = getGatedLoudness(&channel->start);
+            day[c] = getGatedLoudness(&channel->day);
+            clearGatingHistogram(&channel->interval);
         }
-        print_log(LOG_ID, loudness_l, loudness_r);
-        file_log(h->log_dir, LOG_ID, loudness_l, loudness_r);
-        send_broadcast_message(LOG_ID, loudness_l, loudness_r);
+        pushMonitorLog(h->log, MONITOR_REPORT, h->samples, interval[0], interval[1]);
+        pushMonitorLog(h->log, MONITOR_INTEGRATED, h->samples, start[0], start[1]);
+        pushMonitorLog(h->log, MONITOR_INTEGRATED_DAY, h->samples, day[0], day[1]);
+        if (h->meter != NULL) setMeterIntegrated(h->meter, start, day);
     }
 }
-
-#endif
@@ -1,6 +1,3 @@
-#ifndef ebur_plugin
-#define ebur_plugin
-
 //  SPDX-FileCopyrightText: 2016 Milan Chrobok
 //  SPDX-License-Identifier: GPL-3.0-or-later
 
@@ -10,17 +7,21 @@
 #include <math.h>
 #include "ebur128.h"
 #include "amplify.h"
-#include "stereo-plugin.h"
+#include "k-weighting.h"
+#include "plugins.h"
+#include "meter.h"
 
-extern const int IS_LEVELER;
-extern const int LOOK_AHEAD;
-extern const double BUFFER_DURATION1;
-const double SECONDS = 1000.0;
+static const double SECONDS = 1000.0;
+// maximum number of frames passed to libebur128 at once
+#define EBUR_SPAN 1024
 
 struct EburChannel {
     LADSPA_Data* in;
     LADSPA_Data* out;
     ebur128_state* ebur128;
+    // input not yet passed to libebur128, flushed when full and at each adjust point
+    LADSPA_Data span[EBUR_SPAN];
+    unsigned long spanLength;
 
     double amplification;
     double oldAmplification;
@@ -30,18 +31,48 @@ struct EburChannel {
 
 // define our handler type
 typedef struct {
+    const struct PluginConfig* config;
     struct EburChannel left;
     struct EburChannel right;
     unsigned long rate;
     double input_gain;
-
+    LADSPA_Data* latency_port;
+    // linked variants measure both channels in one window with the built-in K-weighting filter
+    struct Window linked;
+    struct KWeighting kWeighting;
+    struct Meter* meter;
 } EburLeveler;
 
-static LADSPA_Handle instantiate(const LADSPA_Descriptor * d, unsigned long rate) {
+static void destroyLeveler(EburLeveler *h) {
+    if (h == NULL) return;
+    struct EburChannel* channels[] = {&h->left, &h->right};
+    for (int i = 0; i < ARRAY_LENGTH(channels); i++) {
+        freeWindow(&channels[i]->window);
+        if (channels[i]->ebur128 != NULL) ebur128_destroy(&channels[i]->ebur128);
+    }
+    freeWindow(&h->linked);
+    closeMeter(h->meter);
+    free(h);
+}
+
+LADSPA_Handle ebur_leveler_instantiate(const LADSPA_Descriptor * d, unsigned long rate) {
+    const struct PluginConfig* config = (const struct PluginConfig*) d->ImplementationData;
     EburLeveler * h = calloc(1, sizeof(EburLeveler));
     if (h == NULL) return NULL;
+    h->config = config;
     h->rate = rate;
     h->input_gain = 1.0;
+    h->meter = openMeter(d->Label, rate);
+
+    if (config->stereoLink) {
+        if (!initWindowChannels(&h->linked, 2, config->lookAhead, config->bufferDuration[0], h->rate, MAX_CHANGE, ADJUST_RATE)
+                || (config->lookAheadDelay > 0 && !setWindowDelay(&h->linked, config->lookAheadDelay, h->rate))) {
+            destroyLeveler(h);
+            return NULL;
+        }
+        initKWeighting(&h->kWeighting, h->rate);
+        return (LADSPA_Handle) h;
+    }
 
     struct EburChannel* channels[] = {&h->left, &h->right};
     for (int i = 0; i < ARRAY_LENGTH(channels); i++) {
@@ -49,40 +80,90 @@ static LADSPA_Handle instantiate(const LADSPA_Descriptor * d, unsigned long rate
 
         struct Window* window;
         window = &channel->window;
-        if(!initWindow(window, LOOK_AHEAD, BUFFER_DURATION1, h->rate, MAX_CHANGE, ADJUST_RATE)){
-            free(h);
+        if(!initWindow(window, config->lookAhead, config->bufferDuration[0], h->rate, MAX_CHANGE, ADJUST_RATE)){
+            destroyLeveler(h);
             return NULL;
         };
+        if (config->lookAheadDelay > 0 && !setWindowDelay(window, config->lookAheadDelay, h->rate)) {
+            destroyLeveler(h);
+            return NULL;
+        }
 
-        channel->ebur128 = ebur128_init(1, h->rate, EBUR128_MODE_LRA);
-        ebur128_set_max_window(channel->ebur128, (unsigned long) (window->duration*SECONDS));
+        // only the sliding window is read, libebur128 keeps no block history in momentary mode,
+        // so memory stays constant however long the instance runs
+        channel->ebur128 = ebur128_init(1, h->rate, EBUR128_MODE_M);
+        if (channel->ebur128 == NULL
+                || ebur128_set_max_window(channel->ebur128, (unsigned long) (window->duration*SECONDS)) != EBUR128_SUCCESS) {
+            destroyLeveler(h);
+            return NULL;
+        }
         channel->amplification = 1.0;
         channel->oldAmplification = 1.0;
     }
     return (LADSPA_Handle) h;
 }
 
-static void cleanup(LADSPA_Handle handle) {
+void ebur_leveler_cleanup(LADSPA_Handle handle) {
     EburLeveler * h = (EburLeveler *) handle;
-    free(h->left.window.data);
-    free(h->right.window.data);
-    ebur128_destroy(&h->left.ebur128);
-    ebur128_destroy(&h->right.ebur128);
-    free(handle);
+    destroyLeveler(h);
 }
 
-static void connect_port(const LADSPA_Handle handle, unsigned long num, LADSPA_Data * port) {
+void ebur_leveler_connect_port(const LADSPA_Handle handle, unsigned long num, LADSPA_Data * port) {
     EburLeveler * h = (EburLeveler *) handle;
     if (num == 0)   h->left.in = port;
     if (num == 1)   h->right.in = port;
     if (num == 2)   h->left.out = port;
     if (num == 3)   h->right.out = port;
     if (num == 4) h->input_gain = pow(10.0, *port / 20.0);
+    if (num == PLUGIN_LATENCY_PORT) h->latency_port = port;
+}
+
+static void flushSpan(struct EburChannel* channel) {
+    if (channel->spanLength == 0) return;
+    ebur128_add_frames_float(channel->ebur128, channel->span, (size_t) channel->spanLength);
+    channel->spanLength = 0;
+}
+
+// process both channels in one pass with one amplification from their K-weighted loudness
+static void runLinked(EburLeveler* h, unsigned long samples) {
+    struct Window* window = &h->linked;
+    struct EburChannel* left = &h->left;
+    struct EburChannel* right = &h->right;
+    if (left->in == NULL || left->out == NULL || right->in == NULL || right->out == NULL) return;
+
+    for (unsigned long s = 0; s < samples; s++) {
+        LADSPA_Data inputLeft = left->in[s] * h->input_gain;
+        LADSPA_Data inputRight = right->in[s] * h->input_gain;
+        prepareWindow(window);
+        addWindowFrame(window, inputLeft, inputRight);
+        sumWindowPower(window, filterKWeighting(&h->kWeighting, inputLeft, inputRight));
+        double ampFactor = interpolateAmplification(window, window->amplification, window->oldAmplification);
+        double valueLeft = inputLeft;
+        double valueRight = inputRight;
+        if (h->config->lookAhead) {
+            valueLeft = window->data[2 * window->playPosition] - getWindowChannelDcOffset(window, 0);
+            valueRight = window->data[2 * window->playPosition + 1] - getWindowChannelDcOffset(window, 1);
+        }
+        left->out[s] = (LADSPA_Data) limit(ampFactor * valueLeft);
+        right->out[s] = (LADSPA_Data) limit(ampFactor * valueRight);
+        if (window->adjustPosition == 0)
+            calcWindowAmplification(window, getWindowLufs(window), h->config->isLeveler, h->input_gain);
+        moveWindow(window);
+    }
+    flushKWeighting(&h->kWeighting);
 }
 
-static void run(LADSPA_Handle handle, unsigned long samples) {
+void ebur_leveler_run(LADSPA_Handle handle, unsigned long samples) {
     EburLeveler * h = (EburLeveler *) handle;
     double loudness_window;
+    if (h->config->stereoLink) {
+        if (h->latency_port != NULL) *(h->latency_port) = (LADSPA_Data) h->linked.delay;
+        runLinked(h, samples);
+        if (h->meter != NULL && addMeterBlock(h->meter, h->left.out, h->right.out, samples))
+            publishMeter(h->meter, h->linked.loudness, h->linked.loudness, h->linked.amplification, h->linked.amplification);
+        return;
+    }
+    if (h->latency_port != NULL) *(h->latency_port) = (LADSPA_Data) h->left.window.delay;
 
     struct EburChannel* channels[] = {&h->left, &h->right};
     for (int c = 0; c < ARRAY_LENGTH(channels); c++) {
@@ -94,12 +175,13 @@ static void run(LADSPA_Handle handle, unsigned long samples) {
             prepareWindow(window);
             LADSPA_Data input = (channel == NULL) ? 0 : channel->in[s] * h->input_gain;
             addWindowData(window, input);
+            sumWindowData(window, input);
 
-            ebur128_add_frames_float(channel->ebur128, &input, (size_t) 1);
+            channel->span[channel->spanLength++] = input;
+            if (channel->spanLength == EBUR_SPAN) flushSpan(channel);
 
             // interpolate with shifted adjust position
-            double ampFactor = interpolateAmplification(channel->amplification, channel->oldAmplification, window->adjustPosition,
-                    window->adjustRate);
+            double ampFactor = interpolateAmplification(window, channel->amplification, channel->oldAmplification);
 
             // read from playPosition, amplify and limit
             double value = (window->data[window->playPosition] - getWindowDcOffset(window)) * ampFactor;
@@ -110,8 +192,9 @@ static void run(LADSPA_Handle handle, unsigned long samples) {
 
             // calculate amplification from EBU R128 values
             if (window->adjustPosition == 0) {
+                flushSpan(channel);
                 ebur128_loudness_window(channel->ebur128, (unsigned long) window->duration*SECONDS, &loudness_window);
-                calcWindowAmplification(window, loudness_window, IS_LEVELER, h->input_gain);
+                calcWindowAmplification(window, loudness_window, h->config->isLeveler, h->input_gain);
 
                 channel->amplification    = window->amplification;
                 channel->oldAmplification = window->oldAmplification;
@@ -126,6 +209,7 @@ static void run(LADSPA_Handle handle, unsigned long samples) {
             moveWindow(window);
         }
     }
+    if (h->meter != NULL && addMeterBlock(h->meter, h->left.out, h->right.out, samples))
+        publishMeter(h->meter, h->left.window.loudness, h->right.window.loudness,
+            h->left.amplification, h->right.amplification);
 }
-
-#endif
@@ -0,0 +1,25 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "plugins.h"
+
+static const struct PluginConfig config = {
+    // set 1 for leveler or 0 for limiter
+    .isLeveler = 1,
+    // use look ahead window, 1 = precise (delayed), 0 = instant (no delay)
+    .lookAhead = 1,
+    // 1 = both channels share one amplification from the built-in K-weighting filter, 0 = libebur128 per channel
+    .stereoLink = 1,
+    // long term measurement window
+    .bufferDuration = {3.0},
+};
+
+const LADSPA_Descriptor ebur128_leveler_3s_linked_descriptor = { .UniqueID = 0x22b415,
+    .Label = "ebur128_leveler_3s_linked", .Name = "EBU R128 leveler -20dBFS, 3 seconds window, stereo linked",
+    .Maker = "Milan Chrobok", .Copyright = "GPL 3",
+    .PortCount = 6, .connect_port = ebur_leveler_connect_port,
+    .PortNames = c_port_names, .PortRangeHints = psPortRangeHints,
+    .PortDescriptors = c_port_descriptors,
+    .ImplementationData = (void*) &config,
+    .instantiate = ebur_leveler_instantiate, .run = ebur_leveler_run, .cleanup = ebur_leveler_cleanup
+};
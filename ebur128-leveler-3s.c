@@ -1,25 +1,23 @@
 //  SPDX-FileCopyrightText: 2016 Milan Chrobok
 //  SPDX-License-Identifier: GPL-3.0-or-later
 
-#include "ebur-plugin.c"
+#include "plugins.h"
 
-// set 1 for leveler or 0 for limiter
-const int IS_LEVELER = 1;
-// use look ahead window, 1 = precise (delayed), 0 = instant (no delay)
-const int LOOK_AHEAD = 1;
-// long term measurement window
-const double BUFFER_DURATION1 = 3.0;
+static const struct PluginConfig config = {
+    // set 1 for leveler or 0 for limiter
+    .isLeveler = 1,
+    // use look ahead window, 1 = precise (delayed), 0 = instant (no delay)
+    .lookAhead = 1,
+    // long term measurement window
+    .bufferDuration = {3.0},
+};
 
-static LADSPA_Descriptor c_ladspa_descriptor = { .UniqueID = 0x22b301,
+const LADSPA_Descriptor ebur128_leveler_3s_descriptor = { .UniqueID = 0x22b301,
     .Label = "ebur128_leveler_3s", .Name = "EBU R128 leveler -20dBFS, 3 seconds window",
     .Maker = "Milan Chrobok", .Copyright = "GPL 3",
-    .PortCount = 5, .connect_port = connect_port,
+    .PortCount = 6, .connect_port = ebur_leveler_connect_port,
     .PortNames = c_port_names, .PortRangeHints = psPortRangeHints,
     .PortDescriptors = c_port_descriptors,
-    .instantiate = instantiate, .run = run, .cleanup = cleanup
+    .ImplementationData = (void*) &config,
+    .instantiate = ebur_leveler_instantiate, .run = ebur_leveler_run, .cleanup = ebur_leveler_cleanup
 };
-
-const LADSPA_Descriptor * ladspa_descriptor(unsigned long i) {
-    if (i == 0) return &c_ladspa_descriptor;
-    return 0;
-}
@@ -1,24 +1,20 @@
 //  SPDX-FileCopyrightText: 2016 Milan Chrobok
 //  SPDX-License-Identifier: GPL-3.0-or-later
 
-#include "ebur-monitor-plugin.c"
+#include "plugins.h"
 
-// use look ahead window, 1 = precise (delayed), 0 = instant (no delay)
-const int LOOK_AHEAD = 1;
-// long term measurement window
-const double BUFFER_DURATION1 = 6.0;
-const char *LOG_ID = "ebur128-in";
+static const struct PluginConfig config = {
+    // long term measurement window
+    .bufferDuration = {6.0},
+    .logId = "ebur128-in",
+};
 
-static LADSPA_Descriptor c_ladspa_descriptor = { .UniqueID = 0x22b305,
+const LADSPA_Descriptor ebur128_monitor_in_6s_descriptor = { .UniqueID = 0x22b305,
     .Label = "ebur128_monitor_in_6s", .Name = "EBU R128 monitor in, 6 seconds window",
     .Maker = "Milan Chrobok", .Copyright = "GPL 3",
-    .PortCount = 4, .connect_port = connect_port,
+    .PortCount = 4, .connect_port = ebur_monitor_connect_port,
     .PortNames = c_port_names, .PortRangeHints = psPortRangeHints,
     .PortDescriptors = c_port_descriptors,
-    .instantiate = instantiate, .run = run, .cleanup = cleanup
+    .ImplementationData = (void*) &config,
+    .instantiate = ebur_monitor_instantiate, .run = ebur_monitor_run, .cleanup = ebur_monitor_cleanup
 };
-
-const LADSPA_Descriptor * ladspa_descriptor(unsigned long i) {
-    if (i == 0) return &c_ladspa_descriptor;
-    return 0;
-}
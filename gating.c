@@ -0,0 +1,65 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "gating.h"
+
+// power of the center of each bin, filled once per process
+static double binPower[GATING_BINS];
+static pthread_once_t binPowerOnce = PTHREAD_ONCE_INIT;
+
+static void initBinPower() {
+    for (int b = 0; b < GATING_BINS; b++)
+        binPower[b] = pow(10.0, (GATING_MIN + (b + 0.5) * GATING_STEP + 0.691) / 10.0);
+}
+
+static double getLufs(double power) {
+    if (power <= 0.0) return -HUGE_VAL;
+    return -0.691 + 10.0 * log10(power);
+}
+
+void addGatingBlock(struct GatingHistogram* histogram, double power) {
+    double loudness = getLufs(power);
+    if (loudness <= GATING_MIN) return;
+    int bin = (int) ((loudness - GATING_MIN) / GATING_STEP);
+    if (bin >= GATING_BINS) bin = GATING_BINS - 1;
+    histogram->count[bin]++;
+}
+
+void addGatingHistogram(struct GatingHistogram* histogram, const struct GatingHistogram* other) {
+    for (int b = 0; b < GATING_BINS; b++)
+        histogram->count[b] += other->count[b];
+}
+
+void subtractGatingHistogram(struct GatingHistogram* histogram, const struct GatingHistogram* other) {
+    for (int b = 0; b < GATING_BINS; b++)
+        histogram->count[b] -= other->count[b];
+}
+
+void clearGatingHistogram(struct GatingHistogram* histogram) {
+    memset(histogram->count, 0, sizeof(histogram->count));
+}
+
+// mean power of the bins from the first one, as loudness
+static double getMeanLoudness(const struct GatingHistogram* histogram, int first) {
+    double sum = 0.0;
+    uint64_t blocks = 0;
+    for (int b = first; b < GATING_BINS; b++) {
+        sum += histogram->count[b] * binPower[b];
+        blocks += histogram->count[b];
+    }
+    return (blocks == 0) ? -HUGE_VAL : getLufs(sum / blocks);
+}
+
+double getGatedLoudness(const struct GatingHistogram* histogram) {
+    pthread_once(&binPowerOnce, initBinPower);
+    double absolute = getMeanLoudness(histogram, 0);
+    if (absolute == -HUGE_VAL) return -HUGE_VAL;
+    double gate = absolute + GATING_RELATIVE;
+    int first = (gate <= GATING_MIN) ? 0 : (int) ceil((gate - GATING_MIN) / GATING_STEP - 0.5);
+    if (first >= GATING_BINS) first = GATING_BINS - 1;
+    return getMeanLoudness(histogram, first);
+}
@@ -0,0 +1,38 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef gating_h
+#define gating_h
+
+// Gated integrated loudness (EBU R128 / ITU-R BS.1770) from a histogram of gating blocks.
+//
+// The loudness of each 400ms gating block is counted in a bin of GATING_STEP LU
+// between GATING_MIN and GATING_MAX LUFS, so the memory is fixed regardless of
+// how many blocks are added. Blocks below the absolute gate of -70 LUFS are not
+// counted, blocks above GATING_MAX are counted in the top bin. The integrated
+// loudness uses the power of the bin centers, which is within GATING_STEP / 2
+// of the exact value. Histograms can be added and subtracted, e.g. to keep a
+// rolling sum of the histograms of the last hours.
+
+#include <stdint.h>
+
+#define GATING_MIN -70.0
+#define GATING_MAX 5.0
+#define GATING_STEP 0.1
+#define GATING_BINS 750
+// relative gate below the absolute gated loudness
+#define GATING_RELATIVE -10.0
+
+struct GatingHistogram {
+    uint32_t count[GATING_BINS];
+};
+
+// add a gating block by its mean square (K-weighted power)
+void addGatingBlock(struct GatingHistogram* histogram, double power);
+void addGatingHistogram(struct GatingHistogram* histogram, const struct GatingHistogram* other);
+void subtractGatingHistogram(struct GatingHistogram* histogram, const struct GatingHistogram* other);
+void clearGatingHistogram(struct GatingHistogram* histogram);
+// gated loudness in LUFS, -HUGE_VAL if no block is above the gates
+double getGatedLoudness(const struct GatingHistogram* histogram);
+
+#endif
@@ -0,0 +1,51 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <string.h>
+#include <math.h>
+#include "k-weighting.h"
+
+// states below this (-600dB) are set to 0
+static const double FLUSH_LIMIT = 1e-30;
+
+static void setStage(struct KWeightingStage* stage, double b0, double b1, double b2, double a1, double a2) {
+    memset(stage, 0, sizeof(*stage));
+    stage->b0 = (KWeightingPair) {b0, b0};
+    stage->b1 = (KWeightingPair) {b1, b1};
+    stage->b2 = (KWeightingPair) {b2, b2};
+    stage->a1 = (KWeightingPair) {a1, a1};
+    stage->a2 = (KWeightingPair) {a2, a2};
+}
+
+void initKWeighting(struct KWeighting* filter, double rate) {
+    // high shelf modelling the head
+    double f0 = 1681.974450955533;
+    double gain = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = tan(M_PI * f0 / rate);
+    double vh = pow(10.0, gain / 20.0);
+    double vb = pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    setStage(&filter->shelf,
+        (vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0,
+        2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0);
+
+    // RLB high pass
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = tan(M_PI * f0 / rate);
+    a0 = 1.0 + k / q + k * k;
+    setStage(&filter->highPass, 1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0);
+}
+
+static void flushStage(struct KWeightingStage* stage) {
+    for (int c = 0; c < 2; c++) {
+        if (fabs(stage->z1[c]) < FLUSH_LIMIT) stage->z1[c] = 0.0;
+        if (fabs(stage->z2[c]) < FLUSH_LIMIT) stage->z2[c] = 0.0;
+    }
+}
+
+void flushKWeighting(struct KWeighting* filter) {
+    flushStage(&filter->shelf);
+    flushStage(&filter->highPass);
+}
@@ -0,0 +1,52 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef k_weighting_h
+#define k_weighting_h
+
+// K-weighting pre-filter of ITU-R BS.1770 for a pair of channels.
+//
+// A high shelf of about +4dB above 1.7kHz followed by a high pass at about 38Hz,
+// each a biquad in transposed direct form II with the coefficients libebur128
+// derives for the sample rate. Both channels are filtered together in the two
+// lanes of one SSE2 vector, the weighted power of a frame is the sum of both
+// lanes as in BS.1770, so a window fed with it measures the programme loudness
+// of the pair instead of two mono loudness values.
+
+#include <ladspa.h>
+
+// left and right channel in the lanes of one vector
+typedef double KWeightingPair __attribute__((vector_size(16)));
+
+struct KWeightingStage {
+    KWeightingPair b0, b1, b2, a1, a2;
+    KWeightingPair z1, z2;
+};
+
+struct KWeighting {
+    struct KWeightingStage shelf;
+    struct KWeightingStage highPass;
+};
+
+void initKWeighting(struct KWeighting* filter, double rate);
+
+// set filter states that decayed below the normal range to 0, called once per block
+// so silence does not run on denormals
+void flushKWeighting(struct KWeighting* filter);
+
+static inline KWeightingPair filterKWeightingStage(struct KWeightingStage* stage, KWeightingPair x) {
+    KWeightingPair y = stage->b0 * x + stage->z1;
+    stage->z1 = stage->b1 * x - stage->a1 * y + stage->z2;
+    stage->z2 = stage->b2 * x - stage->a2 * y;
+    return y;
+}
+
+// K-weighted power of a frame, summed over both channels
+static inline double filterKWeighting(struct KWeighting* filter, LADSPA_Data left, LADSPA_Data right) {
+    KWeightingPair x = {left, right};
+    KWeightingPair y = filterKWeightingStage(&filter->highPass, filterKWeightingStage(&filter->shelf, x));
+    y *= y;
+    return y[0] + y[1];
+}
+
+#endif
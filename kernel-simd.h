@@ -0,0 +1,324 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+// Chunk kernel body, included by kernel.c once per instruction set.
+// KERNEL_NAME(name) adds the instruction set suffix, KERNEL_WIDTH is the number of doubles per vector,
+// the KERNEL_INTERLEAVE_*, KERNEL_DUPLICATE_* and KERNEL_DEINTERLEAVE_* lane orders are used by the linked kernel.
+
+typedef double    KERNEL_NAME(vd) __attribute__((vector_size(KERNEL_WIDTH * sizeof(double))));
+typedef long long KERNEL_NAME(vi) __attribute__((vector_size(KERNEL_WIDTH * sizeof(long long))));
+
+// limit() for all lanes, same operations in the same order as the scalar function
+static inline __attribute__((always_inline))
+KERNEL_NAME(vd) KERNEL_NAME(limitVector)(KERNEL_NAME(vd) value) {
+    typedef KERNEL_NAME(vd) vd;
+    typedef KERNEL_NAME(vi) vi;
+    const vi absMask = (vi) {0} + 0x7fffffffffffffffLL;
+    const vd vCompressionStart = (vd) {0} + compressionStart;
+    const vd vRange = (vd) {0} + LIMIT_RANGE;
+    const vd vMaxLevel = (vd) {0} + MAX_LEVEL;
+
+    vd amplitude = (vd) ((vi) value & absMask);
+    vd u = amplitude - vCompressionStart;
+    u = (vd) ((vi) u & (u > 0.0));
+    vi inRange = u < vRange;
+    u = (vd) (((vi) u & inRange) | ((vi) vRange & ~inRange));
+    vd s = u / (u + 2.0);
+    vd t = s * s;
+    vd t2 = t * t;
+    vd p = ((LIMIT_P0 + LIMIT_P1 * t) + t2 * (LIMIT_P2 + LIMIT_P3 * t))
+        + (t2 * t2) * ((LIMIT_P4 + LIMIT_P5 * t) + t2 * (LIMIT_P6 + LIMIT_P7 * t));
+    vi below = amplitude < vCompressionStart;
+    vd knee = (vd) (((vi) amplitude & below) | ((vi) vCompressionStart & ~below));
+    amplitude = knee + s * p;
+    vi inLevel = amplitude < vMaxLevel;
+    amplitude = (vd) (((vi) amplitude & inLevel) | ((vi) vMaxLevel & ~inLevel));
+    return (vd) ((vi) amplitude | ((vi) value & ~absMask));
+}
+
+// limit a block of samples like the chunk kernels do, used to compare the instruction sets
+static void KERNEL_NAME(limitBlock)(const double* in, LADSPA_Data* out, unsigned long n) {
+    typedef KERNEL_NAME(vd) vd;
+    typedef KERNEL_NAME(vi) vi;
+    typedef float vf __attribute__((vector_size(KERNEL_WIDTH * sizeof(float))));
+    const vi absMask = (vi) {0} + 0x7fffffffffffffffLL;
+    const vd vCompressionStart = (vd) {0} + compressionStart;
+    unsigned long j;
+    for (j = 0; j + KERNEL_WIDTH <= n; j += KERNEL_WIDTH) {
+        vd value;
+        memcpy(&value, in + j, sizeof(value));
+        vi over = (vd) ((vi) value & absMask) > vCompressionStart;
+        long long any = 0;
+        for (int i = 0; i < KERNEL_WIDTH; i++) any |= over[i];
+        if (any) value = KERNEL_NAME(limitVector)(value);
+        vf outF = __builtin_convertvector(value, vf);
+        memcpy(out + j, &outF, sizeof(outF));
+    }
+    for (; j < n; j++) out[j] = (LADSPA_Data) limit(in[j]);
+}
+
+static inline __attribute__((always_inline))
+unsigned long KERNEL_NAME(runChunk)(struct Window* window, const LADSPA_Data* in, LADSPA_Data* out, unsigned long n,
+        double gain, double amp, double oldAmp, const int lookAhead) {
+    typedef double    vd __attribute__((vector_size(KERNEL_WIDTH * sizeof(double))));
+    typedef float     vf __attribute__((vector_size(KERNEL_WIDTH * sizeof(float))));
+    typedef long long vi __attribute__((vector_size(KERNEL_WIDTH * sizeof(long long))));
+
+    // the frames are only stored with look ahead
+    LADSPA_Data* data = NULL;
+    const LADSPA_Data* delayed = NULL;
+    if (lookAhead) {
+        unsigned long playPosition = window->index + window->ringSize - window->delay;
+        if (playPosition >= window->ringSize)
+            playPosition -= window->ringSize;
+        data = window->data + window->index;
+        delayed = window->data + playPosition;
+    }
+    const unsigned long vn = n - n % KERNEL_WIDTH;
+    // frames of the DC sums when the first sample of the chunk is played, only grows within a block
+    const unsigned long size = window->powerSize + 1;
+    // smoothstep of the amplification for the samples of the chunk
+    const double* ramp = window->ramp + window->adjustPosition;
+
+    const vi absMask = (vi) {0} + 0x7fffffffffffffffLL;
+    const vd vGain = (vd) {0} + gain;
+
+    unsigned long j;
+    if (lookAhead) {
+        // output is read from the ring, which is only exact if the dc offset stays zero for the whole chunk
+        vd vDiff = {0};
+        for (j = 0; j < vn; j += KERNEL_WIDTH) {
+            vf inF;
+            memcpy(&inF, in + j, sizeof(inF));
+            vd x = __builtin_convertvector(__builtin_convertvector(__builtin_convertvector(inF, vd) * vGain, vf), vd);
+            vDiff += (vd) ((vi) x & absMask);
+        }
+        double diff = 0.0;
+        for (int i = 0; i < KERNEL_WIDTH; i++) diff += vDiff[i];
+        for (; j < n; j++) {
+            LADSPA_Data x = in[j] * gain;
+            diff += fabs((double) x);
+        }
+        if (fabs(window->sum[0]) + diff >= dcOffsetLimit * size) return 0;
+    }
+
+    const vd vOldAmp = (vd) {0} + oldAmp;
+    const vd vDelta = (vd) {0} + (amp - oldAmp);
+    const vd vCompressionStart = (vd) {0} + compressionStart;
+    vd vSum = {0};
+    vd vSquare = {0};
+    for (j = 0; j < vn; j += KERNEL_WIDTH) {
+        vf inF;
+        memcpy(&inF, in + j, sizeof(inF));
+        vf xF = __builtin_convertvector(__builtin_convertvector(inF, vd) * vGain, vf);
+        vd x = __builtin_convertvector(xF, vd);
+        vd value = x;
+        if (lookAhead) {
+            vf delayedF;
+            memcpy(&delayedF, delayed + j, sizeof(delayedF));
+            value = __builtin_convertvector(delayedF, vd);
+            memcpy(data + j, &xF, sizeof(xF));
+            vSum += x;
+        }
+        vSquare += x * x;
+
+        vd shape;
+        memcpy(&shape, ramp + j, sizeof(shape));
+        vd ampFactor = vOldAmp + shape * vDelta;
+        value *= ampFactor;
+
+        // limit() does not change values up to compressionStart
+        vi over = (vd) ((vi) value & absMask) > vCompressionStart;
+        long long any = 0;
+        for (int i = 0; i < KERNEL_WIDTH; i++) any |= over[i];
+        if (any) value = KERNEL_NAME(limitVector)(value);
+        vf outF = __builtin_convertvector(value, vf);
+        memcpy(out + j, &outF, sizeof(outF));
+    }
+
+    double sum = 0.0;
+    double sumSquare = 0.0;
+    for (int i = 0; i < KERNEL_WIDTH; i++) {
+        sum += vSum[i];
+        sumSquare += vSquare[i];
+    }
+    for (; j < n; j++) {
+        LADSPA_Data x = in[j] * gain;
+        double value = x;
+        if (lookAhead) {
+            value = delayed[j];
+            sum += x;
+            data[j] = x;
+        }
+        sumSquare += (double) x * x;
+        double ampFactor = oldAmp + ramp[j] * (amp - oldAmp);
+        out[j] = (LADSPA_Data) limit(ampFactor * value);
+    }
+
+    window->sum[0] += sum;
+    window->blockSum[0] += sum;
+    window->sumSquare += sumSquare;
+    window->blockPower += sumSquare;
+    advanceWindow(window, n);
+    return n;
+}
+
+// stereo linked chunk kernel, frames are interleaved in the window and share one amplification
+static inline __attribute__((always_inline))
+unsigned long KERNEL_NAME(runLinkedChunk)(struct Window* window, const LADSPA_Data* inLeft, const LADSPA_Data* inRight,
+        LADSPA_Data* outLeft, LADSPA_Data* outRight, unsigned long n, double gain, double amp, double oldAmp, const int lookAhead) {
+    typedef double    vd __attribute__((vector_size(KERNEL_WIDTH * sizeof(double))));
+    typedef float     vf __attribute__((vector_size(KERNEL_WIDTH * sizeof(float))));
+    typedef long long vi __attribute__((vector_size(KERNEL_WIDTH * sizeof(long long))));
+
+    LADSPA_Data* data = NULL;
+    const LADSPA_Data* delayed = NULL;
+    if (lookAhead) {
+        unsigned long playPosition = window->index + window->ringSize - window->delay;
+        if (playPosition >= window->ringSize)
+            playPosition -= window->ringSize;
+        data = window->data + 2 * window->index;
+        delayed = window->data + 2 * playPosition;
+    }
+    const unsigned long vn = n - n % KERNEL_WIDTH;
+    // frames of the DC sums when the first sample of the chunk is played, only grows within a block
+    const unsigned long size = window->powerSize + 1;
+    // smoothstep of the amplification for the samples of the chunk
+    const double* ramp = window->ramp + window->adjustPosition;
+
+    const vi absMask = (vi) {0} + 0x7fffffffffffffffLL;
+    const vd vGain = (vd) {0} + gain;
+
+    // even lanes hold the left, odd lanes the right channel
+    unsigned long j;
+    if (lookAhead) {
+        vd vDiff = {0};
+        for (j = 0; j < vn; j += KERNEL_WIDTH) {
+            vf leftF, rightF;
+            memcpy(&leftF, inLeft + j, sizeof(leftF));
+            memcpy(&rightF, inRight + j, sizeof(rightF));
+            leftF = __builtin_convertvector(__builtin_convertvector(leftF, vd) * vGain, vf);
+            rightF = __builtin_convertvector(__builtin_convertvector(rightF, vd) * vGain, vf);
+            vd low = __builtin_convertvector(__builtin_shufflevector(leftF, rightF, KERNEL_INTERLEAVE_LOW), vd);
+            vd high = __builtin_convertvector(__builtin_shufflevector(leftF, rightF, KERNEL_INTERLEAVE_HIGH), vd);
+            vDiff += (vd) ((vi) low & absMask);
+            vDiff += (vd) ((vi) high & absMask);
+        }
+        double diff[2] = {0.0, 0.0};
+        for (int i = 0; i < KERNEL_WIDTH; i++) diff[i % 2] += vDiff[i];
+        for (; j < n; j++) {
+            LADSPA_Data left = inLeft[j] * gain;
+            LADSPA_Data right = inRight[j] * gain;
+            diff[0] += fabs((double) left);
+            diff[1] += fabs((double) right);
+        }
+        if (fabs(window->sum[0]) + diff[0] >= dcOffsetLimit * size) return 0;
+        if (fabs(window->sum[1]) + diff[1] >= dcOffsetLimit * size) return 0;
+    }
+
+    const vd vOldAmp = (vd) {0} + oldAmp;
+    const vd vDelta = (vd) {0} + (amp - oldAmp);
+    const vd vCompressionStart = (vd) {0} + compressionStart;
+    vd vSum = {0};
+    vd vSquare = {0};
+    for (j = 0; j < vn; j += KERNEL_WIDTH) {
+        vf leftF, rightF;
+        memcpy(&leftF, inLeft + j, sizeof(leftF));
+        memcpy(&rightF, inRight + j, sizeof(rightF));
+        leftF = __builtin_convertvector(__builtin_convertvector(leftF, vd) * vGain, vf);
+        rightF = __builtin_convertvector(__builtin_convertvector(rightF, vd) * vGain, vf);
+        vf lowF = __builtin_shufflevector(leftF, rightF, KERNEL_INTERLEAVE_LOW);
+        vf highF = __builtin_shufflevector(leftF, rightF, KERNEL_INTERLEAVE_HIGH);
+        vd low = __builtin_convertvector(lowF, vd);
+        vd high = __builtin_convertvector(highF, vd);
+        vd valueLow = low;
+        vd valueHigh = high;
+        if (lookAhead) {
+            vf delayedLow, delayedHigh;
+            memcpy(&delayedLow, delayed + 2 * j, sizeof(delayedLow));
+            memcpy(&delayedHigh, delayed + 2 * j + KERNEL_WIDTH, sizeof(delayedHigh));
+            valueLow = __builtin_convertvector(delayedLow, vd);
+            valueHigh = __builtin_convertvector(delayedHigh, vd);
+            memcpy(data + 2 * j, &lowF, sizeof(lowF));
+            memcpy(data + 2 * j + KERNEL_WIDTH, &highF, sizeof(highF));
+            vSum += low + high;
+        }
+        vSquare += low * low + high * high;
+
+        vd shape;
+        memcpy(&shape, ramp + j, sizeof(shape));
+        vd ampFactor = vOldAmp + shape * vDelta;
+        valueLow *= __builtin_shufflevector(ampFactor, ampFactor, KERNEL_DUPLICATE_LOW);
+        valueHigh *= __builtin_shufflevector(ampFactor, ampFactor, KERNEL_DUPLICATE_HIGH);
+
+        vi over = ((vd) ((vi) valueLow & absMask) > vCompressionStart)
+                | ((vd) ((vi) valueHigh & absMask) > vCompressionStart);
+        long long any = 0;
+        for (int i = 0; i < KERNEL_WIDTH; i++) any |= over[i];
+        if (any) {
+            valueLow = KERNEL_NAME(limitVector)(valueLow);
+            valueHigh = KERNEL_NAME(limitVector)(valueHigh);
+        }
+        vf outLow = __builtin_convertvector(valueLow, vf);
+        vf outHigh = __builtin_convertvector(valueHigh, vf);
+        vf left = __builtin_shufflevector(outLow, outHigh, KERNEL_DEINTERLEAVE_EVEN);
+        vf right = __builtin_shufflevector(outLow, outHigh, KERNEL_DEINTERLEAVE_ODD);
+        memcpy(outLeft + j, &left, sizeof(left));
+        memcpy(outRight + j, &right, sizeof(right));
+    }
+
+    double sum[2] = {0.0, 0.0};
+    double sumSquare = 0.0;
+    for (int i = 0; i < KERNEL_WIDTH; i++) {
+        sum[i % 2] += vSum[i];
+        sumSquare += vSquare[i];
+    }
+    for (; j < n; j++) {
+        LADSPA_Data left = inLeft[j] * gain;
+        LADSPA_Data right = inRight[j] * gain;
+        double valueLeft = left;
+        double valueRight = right;
+        if (lookAhead) {
+            valueLeft = delayed[2 * j];
+            valueRight = delayed[2 * j + 1];
+            sum[0] += left;
+            sum[1] += right;
+            data[2 * j] = left;
+            data[2 * j + 1] = right;
+        }
+        sumSquare += (double) left * left + (double) right * right;
+        double ampFactor = oldAmp + ramp[j] * (amp - oldAmp);
+        outLeft[j]  = (LADSPA_Data) limit(ampFactor * valueLeft);
+        outRight[j] = (LADSPA_Data) limit(ampFactor * valueRight);
+    }
+
+    window->sum[0] += sum[0];
+    window->sum[1] += sum[1];
+    window->blockSum[0] += sum[0];
+    window->blockSum[1] += sum[1];
+    window->sumSquare += sumSquare;
+    window->blockPower += sumSquare;
+    advanceWindow(window, n);
+    return n;
+}
+
+// one kernel per look ahead mode, so the sample loops do not test it
+static unsigned long KERNEL_NAME(runChunkLookAhead)(struct Window* window, const LADSPA_Data* in, LADSPA_Data* out,
+        unsigned long n, double gain, double amp, double oldAmp) {
+    return KERNEL_NAME(runChunk)(window, in, out, n, gain, amp, oldAmp, 1);
+}
+
+static unsigned long KERNEL_NAME(runChunkInstant)(struct Window* window, const LADSPA_Data* in, LADSPA_Data* out,
+        unsigned long n, double gain, double amp, double oldAmp) {
+    return KERNEL_NAME(runChunk)(window, in, out, n, gain, amp, oldAmp, 0);
+}
+
+static unsigned long KERNEL_NAME(runLinkedChunkLookAhead)(struct Window* window, const LADSPA_Data* inLeft, const LADSPA_Data* inRight,
+        LADSPA_Data* outLeft, LADSPA_Data* outRight, unsigned long n, double gain, double amp, double oldAmp) {
+    return KERNEL_NAME(runLinkedChunk)(window, inLeft, inRight, outLeft, outRight, n, gain, amp, oldAmp, 1);
+}
+
+static unsigned long KERNEL_NAME(runLinkedChunkInstant)(struct Window* window, const LADSPA_Data* inLeft, const LADSPA_Data* inRight,
+        LADSPA_Data* outLeft, LADSPA_Data* outRight, unsigned long n, double gain, double amp, double oldAmp) {
+    return KERNEL_NAME(runLinkedChunk)(window, inLeft, inRight, outLeft, outRight, n, gain, amp, oldAmp, 0);
+}
@@ -0,0 +1,13 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+// reset the parameters of kernel-simd.h for the next instruction set
+
+#undef KERNEL_NAME
+#undef KERNEL_WIDTH
+#undef KERNEL_INTERLEAVE_LOW
+#undef KERNEL_INTERLEAVE_HIGH
+#undef KERNEL_DUPLICATE_LOW
+#undef KERNEL_DUPLICATE_HIGH
+#undef KERNEL_DEINTERLEAVE_EVEN
+#undef KERNEL_DEINTERLEAVE_ODD
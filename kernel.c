@@ -0,0 +1,106 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <ladspa.h>
+#include "kernel.h"
+
+// lane orders to interleave two channels of KERNEL_WIDTH frames into two vectors and back
+#define KERNEL_NAME(name) name##_generic
+#define KERNEL_WIDTH 2
+#define KERNEL_INTERLEAVE_LOW     0, 2
+#define KERNEL_INTERLEAVE_HIGH    1, 3
+#define KERNEL_DUPLICATE_LOW      0, 0
+#define KERNEL_DUPLICATE_HIGH     1, 1
+#define KERNEL_DEINTERLEAVE_EVEN  0, 2
+#define KERNEL_DEINTERLEAVE_ODD   1, 3
+#include "kernel-simd.h"
+#include "kernel-undef.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#define KERNEL_NAME(name) name##_avx2
+#define KERNEL_WIDTH 4
+#define KERNEL_INTERLEAVE_LOW     0, 4, 1, 5
+#define KERNEL_INTERLEAVE_HIGH    2, 6, 3, 7
+#define KERNEL_DUPLICATE_LOW      0, 0, 1, 1
+#define KERNEL_DUPLICATE_HIGH     2, 2, 3, 3
+#define KERNEL_DEINTERLEAVE_EVEN  0, 2, 4, 6
+#define KERNEL_DEINTERLEAVE_ODD   1, 3, 5, 7
+#include "kernel-simd.h"
+#include "kernel-undef.h"
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#define KERNEL_NAME(name) name##_avx512
+#define KERNEL_WIDTH 8
+#define KERNEL_INTERLEAVE_LOW     0, 8, 1, 9, 2, 10, 3, 11
+#define KERNEL_INTERLEAVE_HIGH    4, 12, 5, 13, 6, 14, 7, 15
+#define KERNEL_DUPLICATE_LOW      0, 0, 1, 1, 2, 2, 3, 3
+#define KERNEL_DUPLICATE_HIGH     4, 4, 5, 5, 6, 6, 7, 7
+#define KERNEL_DEINTERLEAVE_EVEN  0, 2, 4, 6, 8, 10, 12, 14
+#define KERNEL_DEINTERLEAVE_ODD   1, 3, 5, 7, 9, 11, 13, 15
+#include "kernel-simd.h"
+#include "kernel-undef.h"
+#pragma GCC pop_options
+#endif
+
+static void limitBlock_scalar(const double* in, LADSPA_Data* out, unsigned long n) {
+    for (unsigned long j = 0; j < n; j++) out[j] = (LADSPA_Data) limit(in[j]);
+}
+
+// kernels of the selected instruction set, indexed by look ahead
+static ChunkKernel chunkKernel[2] = {NULL, NULL};
+static LinkedChunkKernel linkedChunkKernel[2] = {NULL, NULL};
+static LimitKernel limitKernel = limitBlock_scalar;
+static pthread_once_t chunkKernelOnce = PTHREAD_ONCE_INIT;
+
+#define SELECT_KERNELS(suffix) \
+    chunkKernel[0] = runChunkInstant_##suffix; \
+    chunkKernel[1] = runChunkLookAhead_##suffix; \
+    linkedChunkKernel[0] = runLinkedChunkInstant_##suffix; \
+    linkedChunkKernel[1] = runLinkedChunkLookAhead_##suffix; \
+    limitKernel = limitBlock_##suffix;
+
+static void selectChunkKernel() {
+    const char* simd = getenv("LEVELER_SIMD");
+    if (simd != NULL && strcmp(simd, "scalar") == 0) return;
+    SELECT_KERNELS(generic)
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (simd != NULL && strcmp(simd, "sse2") == 0) return;
+    if (__builtin_cpu_supports("avx2")) {
+        SELECT_KERNELS(avx2)
+    }
+    if (simd != NULL && strcmp(simd, "avx2") == 0) return;
+    if (__builtin_cpu_supports("avx512f")) {
+        SELECT_KERNELS(avx512)
+    }
+#endif
+}
+
+ChunkKernel getChunkKernel(int lookAhead) {
+#ifdef DEBUG
+    // debug output is printed per sample
+    return NULL;
+#endif
+    pthread_once(&chunkKernelOnce, selectChunkKernel);
+    return chunkKernel[lookAhead != 0];
+}
+
+LinkedChunkKernel getLinkedChunkKernel(int lookAhead) {
+#ifdef DEBUG
+    return NULL;
+#endif
+    pthread_once(&chunkKernelOnce, selectChunkKernel);
+    return linkedChunkKernel[lookAhead != 0];
+}
+
+LimitKernel getLimitKernel() {
+    pthread_once(&chunkKernelOnce, selectChunkKernel);
+    return limitKernel;
+}
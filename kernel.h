@@ -0,0 +1,67 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef kernel_h
+#define kernel_h
+
+// Block kernels for the leveler run loop.
+//
+// A chunk is a run of samples of one channel in which no adjust point occurs,
+// no block boundary is crossed and, unless the ring is mirrored, neither the
+// ring index nor the play position wraps. Within such a chunk the amplification
+// only follows the interpolation ramp, so squaring, accumulating, amplifying and
+// limiting can be done for several samples at once.
+//
+// Tolerance against the per-sample path:
+// - output samples are bit-identical for a given amplification; vectors with a lane
+//   above compressionStart are limited by a vector version of limit()
+// - the block sums are accumulated per chunk instead of per sample, so blockSum and
+//   blockPower differ from the scalar path by rounding only (relative ~1e-15),
+//   which may move a loudness value by ~1e-13 dB
+// - a chunk is only processed here if the DC offset is guaranteed to stay
+//   below dcOffsetLimit for all of its samples, otherwise the caller falls
+//   back to the scalar path
+//
+// The instruction set is picked at runtime (AVX-512, AVX2, SSE2). It can be
+// forced by setting LEVELER_SIMD to scalar, sse2, avx2 or avx512.
+
+#include <ladspa.h>
+#include "amplify.h"
+
+// maximum number of samples per chunk
+#define KERNEL_CHUNK 32
+
+// returns number of processed samples, 0 if the chunk has to be processed by the scalar path
+typedef unsigned long (*ChunkKernel)(struct Window* window, const LADSPA_Data* in, LADSPA_Data* out, unsigned long n,
+    double gain, double amp, double oldAmp);
+typedef unsigned long (*LinkedChunkKernel)(struct Window* window, const LADSPA_Data* inLeft, const LADSPA_Data* inRight,
+    LADSPA_Data* outLeft, LADSPA_Data* outRight, unsigned long n, double gain, double amp, double oldAmp);
+
+typedef void (*LimitKernel)(const double* in, LADSPA_Data* out, unsigned long n);
+
+// kernels of the instruction set selected at runtime, NULL for the scalar path
+ChunkKernel getChunkKernel(int lookAhead);
+LinkedChunkKernel getLinkedChunkKernel(int lookAhead);
+// limit() for a block of samples, never NULL
+LimitKernel getLimitKernel();
+
+// get number of samples that can be passed to the chunk kernel, 0 if the next sample needs the scalar path
+static inline unsigned long getChunkSize(struct Window* window, unsigned long samples) {
+    if (!window->active || window->adjustPosition == 0) return 0;
+    unsigned long n = KERNEL_CHUNK;
+    if (n > samples) n = samples;
+    if (n > window->adjustRate - window->adjustPosition) n = window->adjustRate - window->adjustPosition;
+    if (n > WINDOW_BLOCK - window->blockPosition) n = WINDOW_BLOCK - window->blockPosition;
+    if (window->data == NULL) return n;
+    // with a shorter delay the chunk would play back samples it has not written yet
+    if (window->delay < KERNEL_CHUNK) return 0;
+    if (window->mirrored) return n;
+    unsigned long playPosition = window->index + window->ringSize - window->delay;
+    if (playPosition >= window->ringSize)
+        playPosition -= window->ringSize;
+    if (n > window->ringSize - window->index) n = window->ringSize - window->index;
+    if (n > window->ringSize - playPosition)  n = window->ringSize - playPosition;
+    return n;
+}
+
+#endif
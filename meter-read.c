@@ -0,0 +1,70 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+// Reference reader of the shared memory meter segment.
+//
+// Prints the values of all used slots: slot, plugin, sample position, then
+// loudness, peak, gain, momentary, short-term, integrated and 24 hour integrated
+// loudness in dB per channel, every interval milliseconds, or once with interval 0.
+//
+// usage: meter-read name [interval]
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "meter.h"
+
+// consistent copy of a slot, retried while the plugin writes it
+static void readSlot(const struct MeterSlot* slot, struct MeterSlot* copy) {
+    for (;;) {
+        unsigned int before = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (before & 1) continue;
+        memcpy((char*) copy + sizeof(copy->sequence), (const char*) slot + sizeof(slot->sequence),
+            sizeof(struct MeterSlot) - sizeof(slot->sequence));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->sequence, memory_order_relaxed) == before) return;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s name [interval]\n", argv[0]);
+        return 2;
+    }
+    long interval = (argc > 2) ? atol(argv[2]) : 100;
+    int fd = shm_open(argv[1], O_RDONLY, 0);
+    if (fd < 0) {
+        perror(argv[1]);
+        return 1;
+    }
+    const struct MeterSegment* segment = mmap(NULL, sizeof(struct MeterSegment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (segment == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    if (segment->magic != METER_MAGIC || segment->version != METER_VERSION) {
+        fprintf(stderr, "%s: not a meter segment of version %d\n", argv[1], METER_VERSION);
+        return 1;
+    }
+    struct timespec delay = { .tv_sec = interval / 1000, .tv_nsec = interval % 1000 * 1000000 };
+    do {
+        for (int i = 0; i < METER_SLOTS && i < segment->slots; i++) {
+            struct MeterSlot slot;
+            readSlot(&segment->slot[i], &slot);
+            if (!slot.used) continue;
+            printf("%3d %-24.24s %12llu", i, slot.id, (unsigned long long) slot.samples);
+            for (int c = 0; c < METER_CHANNELS; c++)
+                printf("  %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f", slot.loudness[c], slot.peak[c], slot.gain[c],
+                    slot.momentary[c], slot.shortTerm[c], slot.integrated[c], slot.integratedDay[c]);
+            printf("\n");
+        }
+        printf("\n");
+        fflush(stdout);
+    } while (interval > 0 && nanosleep(&delay, NULL) == 0);
+    return 0;
+}
@@ -0,0 +1,138 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "meter.h"
+#include "amplify.h"
+
+static struct MeterSegment* segment = NULL;
+static char segmentName[256];
+// number of instances with a slot
+static int segmentUsers = 0;
+static pthread_mutex_t segmentMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static struct MeterSegment* mapSegment(const char* name) {
+    int fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open meter segment %s: %s\n", name, strerror(errno));
+        return NULL;
+    }
+    void* map = MAP_FAILED;
+    if (ftruncate(fd, sizeof(struct MeterSegment)) == 0)
+        map = mmap(NULL, sizeof(struct MeterSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Failed to map meter segment %s: %s\n", name, strerror(errno));
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    close(fd);
+    // a segment left behind by a previous process is reset
+    struct MeterSegment* meters = (struct MeterSegment*) map;
+    memset(meters, 0, sizeof(struct MeterSegment));
+    meters->magic = METER_MAGIC;
+    meters->version = METER_VERSION;
+    meters->slots = METER_SLOTS;
+    return meters;
+}
+
+struct Meter* openMeter(const char* id, unsigned long rate) {
+    const char* name = getenv("METER_SHM");
+    if (name == NULL || name[0] == '\0') return NULL;
+    struct Meter* meter = calloc(1, sizeof(struct Meter));
+    if (meter == NULL) return NULL;
+    meter->interval = (unsigned long) (METER_INTERVAL * rate);
+    for (int c = 0; c < METER_CHANNELS; c++) {
+        meter->momentary[c] = NAN;
+        meter->shortTerm[c] = NAN;
+        meter->integrated[c] = NAN;
+        meter->integratedDay[c] = NAN;
+    }
+
+    pthread_mutex_lock(&segmentMutex);
+    if (segment == NULL) {
+        segment = mapSegment(name);
+        snprintf(segmentName, sizeof(segmentName), "%s", name);
+    }
+    for (int i = 0; segment != NULL && i < METER_SLOTS; i++) {
+        struct MeterSlot* slot = &segment->slot[i];
+        if (slot->used) continue;
+        unsigned int sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+        atomic_store_explicit(&slot->sequence, sequence + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        slot->used = 1;
+        memset(slot->id, 0, sizeof(slot->id));
+        memcpy(slot->id, id, strnlen(id, sizeof(slot->id) - 1));
+        slot->rate = (uint32_t) rate;
+        slot->channels = METER_CHANNELS;
+        slot->samples = 0;
+        for (int c = 0; c < METER_CHANNELS; c++) {
+            slot->loudness[c] = NAN;
+            slot->peak[c] = NAN;
+            slot->gain[c] = NAN;
+            slot->momentary[c] = NAN;
+            slot->shortTerm[c] = NAN;
+            slot->integrated[c] = NAN;
+            slot->integratedDay[c] = NAN;
+        }
+        atomic_store_explicit(&slot->sequence, sequence + 2, memory_order_release);
+        meter->slot = slot;
+        segmentUsers++;
+        break;
+    }
+    pthread_mutex_unlock(&segmentMutex);
+    if (meter->slot == NULL) {
+        free(meter);
+        return NULL;
+    }
+    return meter;
+}
+
+void publishMeter(struct Meter* meter, double loudnessLeft, double loudnessRight, double ampLeft, double ampRight) {
+    struct MeterSlot* slot = meter->slot;
+    unsigned int sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+    atomic_store_explicit(&slot->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->samples = meter->samples;
+    slot->loudness[0] = (float) loudnessLeft;
+    slot->loudness[1] = (float) loudnessRight;
+    slot->gain[0] = (float) getDbAmplitude(ampLeft);
+    slot->gain[1] = (float) getDbAmplitude(ampRight);
+    for (int c = 0; c < METER_CHANNELS; c++) {
+        slot->peak[c] = (float) getDbAmplitude(meter->peak[c]);
+        slot->momentary[c] = (float) meter->momentary[c];
+        slot->shortTerm[c] = (float) meter->shortTerm[c];
+        slot->integrated[c] = (float) meter->integrated[c];
+        slot->integratedDay[c] = (float) meter->integratedDay[c];
+        meter->peak[c] = 0.0;
+    }
+    atomic_store_explicit(&slot->sequence, sequence + 2, memory_order_release);
+    meter->position = 0;
+}
+
+void closeMeter(struct Meter* meter) {
+    if (meter == NULL) return;
+    pthread_mutex_lock(&segmentMutex);
+    struct MeterSlot* slot = meter->slot;
+    unsigned int sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+    atomic_store_explicit(&slot->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->used = 0;
+    atomic_store_explicit(&slot->sequence, sequence + 2, memory_order_release);
+    if (--segmentUsers == 0) {
+        munmap(segment, sizeof(struct MeterSegment));
+        shm_unlink(segmentName);
+        segment = NULL;
+    }
+    pthread_mutex_unlock(&segmentMutex);
+    free(meter);
+}
@@ -0,0 +1,117 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef meter_h
+#define meter_h
+
+// Current values of all plugin instances in a POSIX shared memory segment.
+//
+// Set METER_SHM to a segment name (e.g. /rms-leveler) to enable it, one process
+// per name. The segment is created by the first instance of the process and
+// removed with the last one. Every instance owns a slot and updates it every
+// METER_INTERVAL seconds from run() with plain stores under a sequence lock, so
+// any number of readers can poll at display rate without a syscall on the
+// audio side. Readers copy a slot and retry while its sequence is odd or
+// changed during the copy.
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <ladspa.h>
+
+#define METER_MAGIC 0x4d4c4d52
+#define METER_VERSION 3
+#define METER_SLOTS 256
+#define METER_CHANNELS 2
+// update interval of a slot, the peak is held over one interval
+#define METER_INTERVAL 0.05
+
+struct MeterSlot {
+    // odd while the slot is written
+    atomic_uint sequence;
+    // 1 while an instance owns the slot
+    uint32_t used;
+    // label of the plugin, zero padded
+    char id[24];
+    uint32_t rate;
+    uint32_t channels;
+    // sample frames processed by the instance since it was instantiated
+    uint64_t samples;
+    // dB values per channel, NAN if the plugin does not measure them:
+    // loudness of the (first) measurement window, peak of the output over the last interval,
+    // amplification applied by a leveler or limiter,
+    // surround levelers publish the front left and right outputs with the loudness and gain of all channels
+    float loudness[METER_CHANNELS];
+    float peak[METER_CHANNELS];
+    float gain[METER_CHANNELS];
+    // momentary (400ms) and short-term (3s) loudness of loudness monitors, updated every 100ms
+    float momentary[METER_CHANNELS];
+    float shortTerm[METER_CHANNELS];
+    // gated integrated loudness of the EBU R128 monitor since instantiation and over the last 24 hours
+    float integrated[METER_CHANNELS];
+    float integratedDay[METER_CHANNELS];
+};
+
+struct MeterSegment {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slots;
+    uint32_t reserved;
+    struct MeterSlot slot[METER_SLOTS];
+};
+
+// slot of an instance with the peak of the current interval
+struct Meter {
+    struct MeterSlot* slot;
+    uint64_t samples;
+    unsigned long interval;
+    unsigned long position;
+    double peak[METER_CHANNELS];
+    double momentary[METER_CHANNELS];
+    double shortTerm[METER_CHANNELS];
+    double integrated[METER_CHANNELS];
+    double integratedDay[METER_CHANNELS];
+};
+
+// claim a slot, NULL if METER_SHM is not set or no slot is free
+struct Meter* openMeter(const char* id, unsigned long rate);
+// publish the loudness in dB and the amplification factors, NAN if not measured, with the peaks of the interval
+void publishMeter(struct Meter* meter, double loudnessLeft, double loudnessRight, double ampLeft, double ampRight);
+void closeMeter(struct Meter* meter);
+
+// set momentary and short-term loudness in dB, published with the next interval
+static inline void setMeterLoudness(struct Meter* meter, const double momentary[METER_CHANNELS],
+        const double shortTerm[METER_CHANNELS]) {
+    for (int c = 0; c < METER_CHANNELS; c++) {
+        meter->momentary[c] = momentary[c];
+        meter->shortTerm[c] = shortTerm[c];
+    }
+}
+
+// set integrated loudness since instantiation and over the last day in dB, published with the next interval
+static inline void setMeterIntegrated(struct Meter* meter, const double integrated[METER_CHANNELS],
+        const double integratedDay[METER_CHANNELS]) {
+    for (int c = 0; c < METER_CHANNELS; c++) {
+        meter->integrated[c] = integrated[c];
+        meter->integratedDay[c] = integratedDay[c];
+    }
+}
+
+// add the peaks of an output block, returns 1 if the interval is complete and publishMeter() is due
+static inline int addMeterBlock(struct Meter* meter, const LADSPA_Data* left, const LADSPA_Data* right,
+        unsigned long samples) {
+    const LADSPA_Data* outs[METER_CHANNELS] = {left, right};
+    for (int c = 0; c < METER_CHANNELS; c++) {
+        if (outs[c] == NULL) continue;
+        LADSPA_Data peak = 0.0f;
+        for (unsigned long s = 0; s < samples; s++) {
+            LADSPA_Data amplitude = outs[c][s] < 0 ? -outs[c][s] : outs[c][s];
+            peak = amplitude > peak ? amplitude : peak;
+        }
+        if (peak > meter->peak[c]) meter->peak[c] = peak;
+    }
+    meter->samples += samples;
+    meter->position += samples;
+    return meter->position >= meter->interval;
+}
+
+#endif
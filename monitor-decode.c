@@ -0,0 +1,115 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+// Reference receiver of the monitor broadcast.
+//
+// Prints one line per record: wall clock with milliseconds, process, instance,
+// sequence, monitor, kind, sample position, rate and the values of all channels.
+// Binary datagrams (MONITOR_FORMAT=binary) are decoded in place, gaps in the
+// sequence of an instance are reported as lost. Text datagrams are passed through.
+//
+// usage: monitor-decode [port]
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "monitor-packet.h"
+#include "stereo-plugin.h"
+
+// instances whose sequence is followed
+#define MAX_INSTANCES 1024
+
+struct Instance {
+    uint32_t process;
+    uint32_t instance;
+    uint32_t sequence;
+};
+
+static const char* const kinds[] = {"report", "momentary", "short-term", "integrated", "integrated-24h"};
+
+static struct Instance instances[MAX_INSTANCES];
+static int instanceCount = 0;
+
+// check the sequence of an instance, returns the number of records lost before this one
+static uint32_t lostRecords(const struct MonitorPacket* packet, const struct MonitorPacketRecord* record) {
+    for (int i = 0; i < instanceCount; i++) {
+        struct Instance* instance = &instances[i];
+        if (instance->process != packet->process || instance->instance != record->instance) continue;
+        uint32_t lost = record->sequence - instance->sequence - 1;
+        instance->sequence = record->sequence;
+        // a restarted instance counts from 0 again
+        return (lost > record->sequence) ? 0 : lost;
+    }
+    if (instanceCount < MAX_INSTANCES)
+        instances[instanceCount++] = (struct Instance) {packet->process, record->instance, record->sequence};
+    return 0;
+}
+
+static void printRecord(const struct MonitorPacket* packet, const struct MonitorPacketRecord* record) {
+    uint32_t lost = lostRecords(packet, record);
+    if (lost > 0) printf("lost %u records of %u/%u\n", lost, packet->process, record->instance);
+    time_t seconds = (time_t) (record->wallClock / 1000000000);
+    struct tm localTime;
+    localtime_r(&seconds, &localTime);
+    char formattedTime[20];
+    strftime(formattedTime, sizeof(formattedTime), "%Y-%m-%d %H:%M:%S", &localTime);
+    const char* kind = (record->kind < sizeof(kinds) / sizeof(kinds[0])) ? kinds[record->kind] : "unknown";
+    printf("%s.%03d\t%u/%u\t%u\t%.*s\t%s\t%llu\t%u", formattedTime, (int) (record->wallClock / 1000000 % 1000),
+        packet->process, record->instance, record->sequence, (int) sizeof(record->id), record->id, kind,
+        (unsigned long long) record->samples, record->rate);
+    for (int c = 0; c < record->channels && c < MONITOR_PACKET_CHANNELS; c++)
+        printf("\t%2.3f", record->values[c]);
+    printf("\n");
+}
+
+static void decode(const char* datagram, size_t length) {
+    const struct MonitorPacket* packet = (const struct MonitorPacket*) datagram;
+    if (length < sizeof(struct MonitorPacket) || packet->magic != MONITOR_PACKET_MAGIC) {
+        fwrite(datagram, 1, length, stdout);
+        return;
+    }
+    if (packet->version != MONITOR_PACKET_VERSION) {
+        fprintf(stderr, "unknown packet version %u\n", packet->version);
+        return;
+    }
+    const struct MonitorPacketRecord* records = (const struct MonitorPacketRecord*) (packet + 1);
+    size_t count = (length - sizeof(struct MonitorPacket)) / sizeof(struct MonitorPacketRecord);
+    if (count > packet->count) count = packet->count;
+    for (size_t i = 0; i < count; i++)
+        printRecord(packet, &records[i]);
+}
+
+int main(int argc, char** argv) {
+    int port = (argc > 1) ? atoi(argv[1]) : BROADCAST_PORT;
+    int s = socket(AF_INET, SOCK_DGRAM, 0);
+    if (s < 0) {
+        perror("socket");
+        return 1;
+    }
+    int reuse = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(s, (struct sockaddr*) &address, sizeof(address)) < 0) {
+        perror("bind");
+        return 1;
+    }
+    static _Alignas(8) char datagram[65536];
+    for (;;) {
+        ssize_t length = recv(s, datagram, sizeof(datagram), 0);
+        if (length < 0) {
+            if (errno == EINTR) continue;
+            perror("recv");
+            return 1;
+        }
+        decode(datagram, (size_t) length);
+        fflush(stdout);
+    }
+}
@@ -0,0 +1,289 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+#include "monitor-log.h"
+#include "stereo-plugin.h"
+
+// records per monitor, a power of 2; reports come every few seconds, so this only fills if the writer is stuck
+#define MONITOR_LOG_QUEUE 64
+// tick of the writer thread in milliseconds, the reports of all monitors in a tick are sent together
+#define MONITOR_LOG_POLL 100
+// maximum size of a broadcast datagram, fits into an ethernet frame
+#define MONITOR_DATAGRAM 1400
+
+struct MonitorRecord {
+    struct timespec time;
+    uint64_t samples;
+    uint32_t sequence;
+    int kind;
+    double left;
+    double right;
+};
+
+struct MonitorLog {
+    struct MonitorRecord records[MONITOR_LOG_QUEUE];
+    // written by the producer only
+    atomic_ulong tail;
+    // written by the writer thread only
+    atomic_ulong head;
+    atomic_ulong dropped;
+    // number of the next report, written by the producer only
+    uint32_t sequence;
+    uint32_t instance;
+    unsigned long rate;
+    const char* logId;
+    const char* logDir;
+    // log file of the current date, owned by the writer thread
+    FILE* file;
+    char date[11];
+    struct MonitorLog* next;
+};
+
+static struct MonitorLog* logs = NULL;
+// guards the list of logs, their files and the datagram, never taken by the audio thread
+static pthread_mutex_t logMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t logCondition = PTHREAD_COND_INITIALIZER;
+// serializes starting and stopping of the writer thread
+static pthread_mutex_t writerMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t writer;
+static int writerRunning = 0;
+static int writerStop = 0;
+static uint32_t nextInstance = 0;
+
+// broadcast socket, open while any monitor is registered
+static int broadcastSocket = -1;
+static struct sockaddr_in broadcastAddress;
+// send struct MonitorPacket instead of text lines
+static int binaryFormat = 0;
+// reports of the current tick, sent as one datagram, aligned for the binary records
+static _Alignas(8) char datagram[MONITOR_DATAGRAM];
+static size_t datagramLength = 0;
+
+static void openSocket() {
+    const char* format = getenv("MONITOR_FORMAT");
+    binaryFormat = format != NULL && strcmp(format, "binary") == 0;
+    broadcastSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (broadcastSocket < 0) {
+        fprintf(stderr, "Error creating broadcast socket: %s\n", strerror(errno));
+        return;
+    }
+    int broadcastEnable = 1;
+    if (setsockopt(broadcastSocket, SOL_SOCKET, SO_BROADCAST, &broadcastEnable, sizeof(broadcastEnable)) < 0) {
+        fprintf(stderr, "Error enabling broadcast: %s\n", strerror(errno));
+        close(broadcastSocket);
+        broadcastSocket = -1;
+        return;
+    }
+    memset(&broadcastAddress, 0, sizeof(broadcastAddress));
+    broadcastAddress.sin_family = AF_INET;
+    broadcastAddress.sin_port = htons(BROADCAST_PORT);
+    broadcastAddress.sin_addr.s_addr = inet_addr(BROADCAST_ADDRESS);
+}
+
+static void closeSocket() {
+    if (broadcastSocket >= 0) close(broadcastSocket);
+    broadcastSocket = -1;
+}
+
+static void sendDatagram() {
+    if (datagramLength == 0) return;
+    if (broadcastSocket >= 0 && sendto(broadcastSocket, datagram, datagramLength, MSG_DONTWAIT,
+            (struct sockaddr*) &broadcastAddress, sizeof(broadcastAddress)) < 0)
+        fprintf(stderr, "Error sending broadcast message: %s\n", strerror(errno));
+    datagramLength = 0;
+}
+
+// add a line to the datagram, lines are never split between datagrams
+static void appendDatagram(const char* line) {
+    size_t length = strlen(line);
+    if (datagramLength + length > sizeof(datagram)) sendDatagram();
+    if (length > sizeof(datagram)) return;
+    memcpy(datagram + datagramLength, line, length);
+    datagramLength += length;
+}
+
+// add a record to the datagram, starting with the header
+static void appendPacket(const struct MonitorLog* log, const struct MonitorRecord* record) {
+    if (datagramLength + sizeof(struct MonitorPacketRecord) > sizeof(datagram)) sendDatagram();
+    struct MonitorPacket* packet = (struct MonitorPacket*) datagram;
+    if (datagramLength == 0) {
+        memset(packet, 0, sizeof(struct MonitorPacket));
+        packet->magic = MONITOR_PACKET_MAGIC;
+        packet->version = MONITOR_PACKET_VERSION;
+        packet->process = (uint32_t) getpid();
+        datagramLength = sizeof(struct MonitorPacket);
+    }
+    struct MonitorPacketRecord* out = (struct MonitorPacketRecord*) (datagram + datagramLength);
+    memset(out, 0, sizeof(struct MonitorPacketRecord));
+    memcpy(out->id, log->logId, strnlen(log->logId, sizeof(out->id)));
+    out->samples = record->samples;
+    out->wallClock = (int64_t) record->time.tv_sec * 1000000000 + record->time.tv_nsec;
+    out->instance = log->instance;
+    out->sequence = record->sequence;
+    out->rate = (uint32_t) log->rate;
+    out->channels = MONITOR_PACKET_CHANNELS;
+    out->kind = (uint16_t) record->kind;
+    out->values[0] = (float) record->left;
+    out->values[1] = (float) record->right;
+    packet->count++;
+    datagramLength += sizeof(struct MonitorPacketRecord);
+}
+
+static void writeFile(struct MonitorLog* log, const struct MonitorRecord* record, const struct tm* localTime,
+        const char* formattedTime) {
+    char formattedDate[11];
+    strftime(formattedDate, sizeof(formattedDate), "%Y-%m-%d", localTime);
+    if (log->file != NULL && strcmp(formattedDate, log->date) != 0) {
+        fclose(log->file);
+        log->file = NULL;
+    }
+    if (log->file == NULL) {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%s-monitor-%s.log", log->logDir, formattedDate, log->logId);
+        log->file = fopen(path, "a");
+        if (log->file == NULL) {
+            fprintf(stderr, "%s Failed to open log file %s: %s.\n", formattedTime, path, strerror(errno));
+            return;
+        }
+        memcpy(log->date, formattedDate, sizeof(log->date));
+    }
+    fprintf(log->file, "%s\t%2.3f\t%2.3f\n", formattedTime, record->left, record->right);
+    fflush(log->file);
+}
+
+// write all queued records of a log and add them to the datagram, logMutex held
+static void writeRecords(struct MonitorLog* log) {
+    unsigned long head = atomic_load_explicit(&log->head, memory_order_relaxed);
+    unsigned long tail = atomic_load_explicit(&log->tail, memory_order_acquire);
+    for (; head != tail; head++) {
+        const struct MonitorRecord* record = &log->records[head & (MONITOR_LOG_QUEUE - 1)];
+        if (record->kind != MONITOR_REPORT) {
+            appendPacket(log, record);
+            atomic_store_explicit(&log->head, head + 1, memory_order_release);
+            continue;
+        }
+        struct tm localTime;
+        localtime_r(&record->time.tv_sec, &localTime);
+        char formattedTime[20];
+        strftime(formattedTime, sizeof(formattedTime), "%Y-%m-%d %H:%M:%S", &localTime);
+        fprintf(stderr, "%s %s\t%2.3f\t%2.3f\n", formattedTime, log->logId, record->left, record->right);
+        writeFile(log, record, &localTime, formattedTime);
+        if (binaryFormat) {
+            appendPacket(log, record);
+        } else {
+            char line[256];
+            snprintf(line, sizeof(line), "%s\t%s\t%2.3f\t%2.3f\n", formattedTime, log->logId, record->left,
+                record->right);
+            appendDatagram(line);
+        }
+        atomic_store_explicit(&log->head, head + 1, memory_order_release);
+    }
+    unsigned long dropped = atomic_exchange_explicit(&log->dropped, 0, memory_order_relaxed);
+    if (dropped > 0) fprintf(stderr, "%s: dropped %lu monitor reports\n", log->logId, dropped);
+}
+
+static void* runWriter(void* unused) {
+    pthread_mutex_lock(&logMutex);
+    while (!writerStop) {
+        for (struct MonitorLog* log = logs; log != NULL; log = log->next)
+            writeRecords(log);
+        sendDatagram();
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += MONITOR_LOG_POLL * 1000000L;
+        if (ts.tv_nsec >= 1000000000L) {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&logCondition, &logMutex, &ts);
+    }
+    pthread_mutex_unlock(&logMutex);
+    return NULL;
+}
+
+struct MonitorLog* openMonitorLog(const char* logId, unsigned long rate) {
+    struct MonitorLog* log = calloc(1, sizeof(struct MonitorLog));
+    if (log == NULL) return NULL;
+    log->logId = logId;
+    log->rate = rate;
+    log->logDir = getenv("MONITOR_LOG_DIR");
+    if (log->logDir == NULL)
+        log->logDir = "/var/log/monitor";
+    atomic_init(&log->head, 0);
+    atomic_init(&log->tail, 0);
+    atomic_init(&log->dropped, 0);
+
+    pthread_mutex_lock(&writerMutex);
+    pthread_mutex_lock(&logMutex);
+    if (logs == NULL) openSocket();
+    log->instance = nextInstance++;
+    log->next = logs;
+    logs = log;
+    if (!writerRunning) {
+        writerStop = 0;
+        writerRunning = pthread_create(&writer, NULL, runWriter, NULL) == 0;
+        if (!writerRunning) fprintf(stderr, "Error starting monitor log writer\n");
+    }
+    pthread_mutex_unlock(&logMutex);
+    pthread_mutex_unlock(&writerMutex);
+    return log;
+}
+
+void pushMonitorLog(struct MonitorLog* log, int kind, uint64_t samples, double left, double right) {
+    unsigned long tail = atomic_load_explicit(&log->tail, memory_order_relaxed);
+    unsigned long head = atomic_load_explicit(&log->head, memory_order_acquire);
+    if (kind != MONITOR_REPORT && !binaryFormat) return;
+    uint32_t sequence = log->sequence++;
+    int frequent = (kind == MONITOR_MOMENTARY || kind == MONITOR_SHORT_TERM);
+    if (tail - head >= (frequent ? MONITOR_LOG_QUEUE / 2 : MONITOR_LOG_QUEUE)) {
+        atomic_fetch_add_explicit(&log->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    struct MonitorRecord* record = &log->records[tail & (MONITOR_LOG_QUEUE - 1)];
+    clock_gettime(CLOCK_REALTIME, &record->time);
+    record->samples = samples;
+    record->sequence = sequence;
+    record->kind = kind;
+    record->left = left;
+    record->right = right;
+    atomic_store_explicit(&log->tail, tail + 1, memory_order_release);
+}
+
+void closeMonitorLog(struct MonitorLog* log) {
+    if (log == NULL) return;
+    pthread_mutex_lock(&writerMutex);
+    pthread_mutex_lock(&logMutex);
+    for (struct MonitorLog** entry = &logs; *entry != NULL; entry = &(*entry)->next) {
+        if (*entry != log) continue;
+        *entry = log->next;
+        break;
+    }
+    writeRecords(log);
+    sendDatagram();
+    if (log->file != NULL) fclose(log->file);
+    int last = logs == NULL;
+    if (last) {
+        closeSocket();
+        writerStop = 1;
+        pthread_cond_signal(&logCondition);
+    }
+    pthread_mutex_unlock(&logMutex);
+    if (last && writerRunning) {
+        pthread_join(writer, NULL);
+        writerRunning = 0;
+    }
+    pthread_mutex_unlock(&writerMutex);
+    free(log);
+}
@@ -0,0 +1,44 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef monitor_log_h
+#define monitor_log_h
+
+// Monitor reports, written off the audio thread.
+//
+// run() pushes a fixed size record into the lock free single producer single
+// consumer queue of its monitor. One writer thread per process drains the
+// queues of all monitors, prints the reports and appends them to a log file per
+// day and monitor in MONITOR_LOG_DIR (kept open, reopened when the date
+// changes). If the queue is full the record is dropped and counted, the audio
+// thread never waits. Momentary, short-term and integrated records are only
+// queued for the binary format. The 100ms momentary and short-term records are
+// only queued while the queue is at most half full, so they never push out
+// interval reports when the host runs faster than real time.
+// Prints, log files and text lines carry the interval reports only.
+//
+// The writer thread also owns the broadcast socket, which is open while any
+// monitor is registered. The reports of all monitors collected in one tick are
+// sent together, as few datagrams as fit the lines. The datagrams are text lines
+// by default, or binary records (see monitor-packet.h) with MONITOR_FORMAT=binary.
+
+#include <stdint.h>
+#include "monitor-packet.h"
+
+// momentary (400ms) and short-term (3s) loudness of the loudness monitors,
+// updated MONITOR_LOUDNESS_RATE times per second over the last blocks of that length
+#define MONITOR_LOUDNESS_RATE 10
+#define MONITOR_MOMENTARY_BLOCKS 4
+#define MONITOR_SHORT_TERM_BLOCKS 30
+
+struct MonitorLog;
+
+// register a monitor, starts the writer thread with the first one, NULL on failure
+struct MonitorLog* openMonitorLog(const char* logId, unsigned long rate);
+// queue a record of a kind (MONITOR_REPORT, MONITOR_MOMENTARY, ... see monitor-packet.h) at the current time,
+// after the given number of sample frames since instantiation, called from run()
+void pushMonitorLog(struct MonitorLog* log, int kind, uint64_t samples, double left, double right);
+// write the queued reports and unregister, stops the writer thread with the last one
+void closeMonitorLog(struct MonitorLog* log);
+
+#endif
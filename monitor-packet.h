@@ -0,0 +1,67 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef monitor_packet_h
+#define monitor_packet_h
+
+// Binary format of the monitor broadcast, selected by MONITOR_FORMAT=binary.
+//
+// A datagram is a header followed by count records of fixed size, in the byte
+// order of the sender (little endian on all supported hosts, a swapped magic
+// tells otherwise). All fields are naturally aligned, so a receiver can read a
+// datagram into an 8 byte aligned buffer and use the structs in place.
+//
+// The sequence number of an instance counts every record, including records
+// dropped before sending, so gaps show lost records. The sample counter and the
+// wall clock anchor belong to the same moment, the end of the run() block that
+// completed the report, so reports of different monitors can be aligned by
+// sample position instead of by arrival time.
+//
+// Besides the interval reports, loudness monitors send momentary (400ms) and
+// short-term (3s) loudness every 100ms, told apart by the kind of the record.
+// The EBU R128 monitor adds its integrated loudness since instantiation and
+// over the last 24 hours to each interval report.
+
+#include <stdint.h>
+
+#define MONITOR_PACKET_MAGIC 0x4d4c5652
+#define MONITOR_PACKET_VERSION 3
+#define MONITOR_PACKET_CHANNELS 2
+
+// kinds of records
+#define MONITOR_REPORT 0
+#define MONITOR_MOMENTARY 1
+#define MONITOR_SHORT_TERM 2
+#define MONITOR_INTEGRATED 3
+#define MONITOR_INTEGRATED_DAY 4
+
+struct MonitorPacket {
+    uint32_t magic;
+    uint16_t version;
+    // number of records following the header
+    uint16_t count;
+    // process id of the sender, instance ids are unique per process
+    uint32_t process;
+    uint32_t reserved;
+};
+
+struct MonitorPacketRecord {
+    // logId of the monitor, e.g. rms-in, zero padded
+    char id[16];
+    // sample frames processed by the instance since it was instantiated
+    uint64_t samples;
+    // wall clock at that sample, nanoseconds since the epoch
+    int64_t wallClock;
+    uint32_t instance;
+    uint32_t sequence;
+    uint32_t rate;
+    uint16_t channels;
+    uint16_t kind;
+    // dB values per channel
+    float values[MONITOR_PACKET_CHANNELS];
+};
+
+_Static_assert(sizeof(struct MonitorPacket) == 16, "monitor packet header layout");
+_Static_assert(sizeof(struct MonitorPacketRecord) == 56, "monitor packet record layout");
+
+#endif
@@ -1,21 +1,13 @@
 //  SPDX-FileCopyrightText: 2016 Milan Chrobok
 //  SPDX-License-Identifier: GPL-3.0-or-later
 
-#ifndef multi_window_plugin
-#define multi_window_plugin
-
 #include <stdlib.h>
 #include <ladspa.h>
 #include <stdio.h>
 #include <math.h>
 #include "amplify.h"
-#include "stereo-plugin.h"
-
-extern const int IS_LEVELER;
-extern const int LOOK_AHEAD;
-extern const double BUFFER_DURATION1;
-extern const double BUFFER_DURATION2;
-extern const double BUFFER_DURATION3;
+#include "plugins.h"
+#include "meter.h"
 
 struct Channel {
     LADSPA_Data* in;
@@ -23,163 +15,201 @@ struct Channel {
 
     double amplification;
     double oldAmplification;
-    double oldAmplificationSmoothed;
 
-    struct Window window1;
-    struct Window window2;
-    struct Window window3;
+    // delay line and power history of the longest window, shared by all windows
+    struct Window history;
+    // amplification per window, measured from a range of the history, these windows hold no samples
+    struct Window windows[PLUGIN_MAX_WINDOWS];
+    int range[PLUGIN_MAX_WINDOWS];
 };
 
 // define our handler type
 typedef struct {
+    const struct PluginConfig* config;
     struct Channel left;
     struct Channel right;
     unsigned long rate;
     double input_gain;
+    LADSPA_Data* input_gain_port;
+    LADSPA_Data* latency_port;
+    // control ports of configurable variants, NULL if not connected
+    LADSPA_Data* window_port;
+    LADSPA_Data* target_port;
+    LADSPA_Data* max_change_port;
+    LADSPA_Data* leveler_port;
+    // duration of the first window, which the window port changes within the history
+    double windowDuration;
+    // number of used windows and their normalized weights
+    int windows;
+    double weight[PLUGIN_MAX_WINDOWS];
+    struct Meter* meter;
 } Leveler;
 
-void destroyLeveler(Leveler *h) {
+static void destroyLeveler(Leveler *h) {
     if (h == NULL) return;
-    freeWindow(&h->left.window1);
-    freeWindow(&h->left.window2);
-    freeWindow(&h->left.window3);
-    freeWindow(&h->right.window1);
-    freeWindow(&h->right.window2);
-    freeWindow(&h->right.window3);
+    freeWindow(&h->left.history);
+    freeWindow(&h->right.history);
+    closeMeter(h->meter);
     free(h);
 }
 
-static LADSPA_Handle instantiate(const LADSPA_Descriptor * d, unsigned long rate) {
+LADSPA_Handle multi_window_instantiate(const LADSPA_Descriptor * d, unsigned long rate) {
+    const struct PluginConfig* config = (const struct PluginConfig*) d->ImplementationData;
     Leveler *h = calloc(1, sizeof(Leveler));
     if (h == NULL) return NULL;
+    h->config = config;
     h->rate = rate;
     h->input_gain = 1.0;
+    h->meter = openMeter(d->Label, rate);
+
+    // the history has to hold the longest window
+    double duration = 0.0;
+    double weights = 0.0;
+    for (int w = 0; w < PLUGIN_MAX_WINDOWS && config->bufferDuration[w] > 0; w++) {
+        if (config->bufferDuration[w] > duration) duration = config->bufferDuration[w];
+        weights += config->bufferWeight[w];
+        h->windows++;
+    }
+    for (int w = 0; w < h->windows; w++)
+        h->weight[w] = (weights > 0) ? config->bufferWeight[w] / weights : 1.0 / h->windows;
+    h->windowDuration = config->bufferDuration[0];
 
     struct Channel* channels[] = {&h->left, &h->right};
     for (int c = 0; c < ARRAY_LENGTH(channels); c++) {
         struct Channel* channel = channels[c];
-        channel->amplification = 0.0;
-        channel->oldAmplification = 0.0;
-        channel->oldAmplificationSmoothed = 0.0;
-        if(!initWindow(&channel->window1, LOOK_AHEAD, BUFFER_DURATION1, h->rate, MAX_CHANGE, ADJUST_RATE)) {
+        channel->amplification = 1.0;
+        channel->oldAmplification = 1.0;
+        if (!initWindow(&channel->history, config->lookAhead, duration, h->rate, MAX_CHANGE, ADJUST_RATE)) {
             destroyLeveler(h);
             return NULL;
         }
-        if(!initWindow(&channel->window2, LOOK_AHEAD, BUFFER_DURATION2, h->rate, MAX_CHANGE, ADJUST_RATE)) {
+        if (config->lookAheadDelay > 0 && !setWindowDelay(&channel->history, config->lookAheadDelay, h->rate)) {
             destroyLeveler(h);
             return NULL;
         }
-        if(!initWindow(&channel->window3, LOOK_AHEAD, BUFFER_DURATION3, h->rate, MAX_CHANGE, ADJUST_RATE)) {
-            destroyLeveler(h);
-            return NULL;
+        for (int w = 0; w < h->windows; w++) {
+            initWindow(&channel->windows[w], 0, 0.0, h->rate, MAX_CHANGE, ADJUST_RATE);
+            channel->range[w] = addWindowRange(&channel->history, config->bufferDuration[w], h->rate);
+            if (channel->range[w] < 0) {
+                destroyLeveler(h);
+                return NULL;
+            }
         }
     }
     return (LADSPA_Handle) h;
 }
 
-static void cleanup(LADSPA_Handle handle) {
+void multi_window_cleanup(LADSPA_Handle handle) {
     Leveler * h = (Leveler *) handle;
     destroyLeveler(h);
 }
 
-static void connect_port(const LADSPA_Handle handle, unsigned long num, LADSPA_Data * port) {
+void multi_window_connect_port(const LADSPA_Handle handle, unsigned long num, LADSPA_Data * port) {
     Leveler * h = (Leveler *) handle;
     if (num == 0) h->left.in = port;
     if (num == 1) h->right.in = port;
     if (num == 2) h->left.out = port;
     if (num == 3) h->right.out = port;
+    if (num == 4) h->input_gain_port = port;
+    if (num == PLUGIN_LATENCY_PORT) h->latency_port = port;
+    if (num == PLUGIN_WINDOW_PORT) h->window_port = port;
+    if (num == PLUGIN_TARGET_PORT) h->target_port = port;
+    if (num == PLUGIN_MAX_CHANGE_PORT) h->max_change_port = port;
+    if (num == PLUGIN_LEVELER_PORT) h->leveler_port = port;
 }
 
-void getAvgAmp(struct Channel* channel, struct Window* window1, struct Window* window2, struct Window* window3) {
-    double sum = 0;
-    double amp = 0;
-    double oldAmp = 0;
-    if (window1->active){
-        sum++;
-        amp += window1->amplification;
-        oldAmp += window1->oldAmplification;
-    }
-    if (window2->active){
-        sum++;
-        amp += window2->amplification;
-        oldAmp += window2->oldAmplification;
+static double clampControl(LADSPA_Data value, double lower, double upper) {
+    if (!(value >= lower)) return lower;
+    return (value > upper) ? upper : value;
+}
+
+// apply the control ports, the history and the windows keep running, so changes take effect
+// from the next adjust point on along the usual amplification ramp
+static void applyControls(Leveler* h) {
+    struct Channel* channels[] = {&h->left, &h->right};
+    if (h->window_port != NULL) {
+        const LADSPA_PortRangeHint* hint = &psControlPortRangeHints[PLUGIN_WINDOW_PORT];
+        double duration = clampControl(*h->window_port, hint->LowerBound, h->config->bufferDuration[0]);
+        if (duration != h->windowDuration) {
+            for (int c = 0; c < ARRAY_LENGTH(channels); c++)
+                setWindowRange(&channels[c]->history, channels[c]->range[0], duration, h->rate);
+            h->windowDuration = duration;
+        }
     }
-    if (window3->active){
-        sum++;
-        amp += window2->amplification;
-        oldAmp += window3->oldAmplification;
+    for (int c = 0; c < ARRAY_LENGTH(channels); c++) {
+        for (int w = 0; w < h->windows; w++) {
+            struct Window* window = &channels[c]->windows[w];
+            if (h->target_port != NULL) {
+                const LADSPA_PortRangeHint* hint = &psControlPortRangeHints[PLUGIN_TARGET_PORT];
+                window->target = clampControl(*h->target_port, hint->LowerBound, hint->UpperBound);
+            }
+            if (h->max_change_port != NULL) {
+                const LADSPA_PortRangeHint* hint = &psControlPortRangeHints[PLUGIN_MAX_CHANGE_PORT];
+                window->maxAmpChange = clampControl(*h->max_change_port, hint->LowerBound, hint->UpperBound) * ADJUST_RATE;
+            }
+        }
     }
+}
 
-    channel->amplification = amp / sum;
-    channel->oldAmplification = oldAmp / sum;
+// update the amplification of each window and combine them by their weights
+static void calcAmplification(Leveler* h, struct Channel* channel, const int isLeveler) {
+    double amp = 0.0;
+    double oldAmp = 0.0;
+    for (int w = 0; w < h->windows; w++) {
+        struct Window* window = &channel->windows[w];
+        calcWindowAmplification(window, getWindowRangeLoudness(&channel->history, channel->range[w]),
+            isLeveler, h->input_gain);
+        amp += h->weight[w] * window->amplification;
+        oldAmp += h->weight[w] * window->oldAmplification;
+    }
+    channel->amplification = amp;
+    channel->oldAmplification = oldAmp;
 }
 
-static void run(LADSPA_Handle handle, unsigned long samples) {
+void multi_window_run(LADSPA_Handle handle, unsigned long samples) {
     Leveler * h = (Leveler *) handle;
     if (h == NULL || h->input_gain_port == NULL || samples == 0) return;
+    applyControls(h);
+    const int isLeveler = (h->leveler_port != NULL) ? *(h->leveler_port) > 0 : h->config->isLeveler;
+    const int lookAhead = h->config->lookAhead;
+    h->input_gain = pow(10.0, *(h->input_gain_port) / 20.0);
+    if (h->latency_port != NULL) *(h->latency_port) = (LADSPA_Data) h->left.history.delay;
 
     struct Channel* channels[] = {&h->left, &h->right};
     for (int c = 0; c < ARRAY_LENGTH(channels); c++) {
         struct Channel* channel = channels[c];
         if (channel->in == NULL || channel->out == NULL) continue;
-        struct Window* window1 = &channel->window1;
-        struct Window* window2 = &channel->window2;
-        struct Window* window3 = &channel->window3;
+        struct Window* history = &channel->history;
 
         for (unsigned long s = 0; s < samples; s++) {
-
-            LADSPA_Data input = (channel == NULL) ? 0 : channel->in[s] * h->input_gain;
-            if (window1->active){
-                prepareWindow(window1);
-                addWindowData(window1, input);
-                sumWindowData(window1);
-            }
-            if (window2->active){
-                prepareWindow(window2);
-                addWindowData(window2, input);
-                sumWindowData(window2);
-            }
-            if (window3->active){
-                prepareWindow(window3);
-                addWindowData(window3, input);
-                sumWindowData(window3);
-            }
+            LADSPA_Data input = channel->in[s] * h->input_gain;
+            prepareWindow(history);
+            addWindowData(history, input);
+            sumWindowData(history, input);
 
             // interpolate with shifted adjust position
-            double ampFactor = interpolateAmplification(channel->amplification, channel->oldAmplification,
-                    window1->adjustPosition, window1->adjustRate);
+            double ampFactor = interpolateAmplification(history, channel->amplification, channel->oldAmplification);
 
             // read from playPosition, amplify and limit
-            double value = (window1->data[window1->playPosition] - getWindowDcOffset(window1)) * ampFactor;
-            value = limit(value);
-            if (channel->out != NULL) {
-                channel->out[s] = (LADSPA_Data) value;
-            }
-
+            double value =
+                lookAhead
+                ? history->data[history->playPosition] - getWindowDcOffset(history)
+                : input;
+            channel->out[s] = (LADSPA_Data) limit(value * ampFactor);
+
+            if (history->adjustPosition == 0) {
+                calcAmplification(h, channel, isLeveler);
 #ifdef DEBUG
-            printWindow(window1, c ==  ARRAY_LENGTH(channels)-1 );
+                fprintf(stderr, "%.1f", history->position);
+                for (int w = 0; w < h->windows; w++)
+                    fprintf(stderr, "\t%2.3f\t%2.3f", channel->windows[w].loudness, channel->windows[w].amplification);
+                fprintf(stderr, c == ARRAY_LENGTH(channels) - 1 ? "\n" : "  ");
 #endif
-
-            if (window1->active && window1->adjustPosition == 0){
-                calcWindowAmplification(window1, getRmsValue(window1->sumSquare, window1->size), IS_LEVELER, h->input_gain);
-            }
-            if (window2->active && window2->adjustPosition == 0){
-                calcWindowAmplification(window2, getRmsValue(window2->sumSquare, window2->size), IS_LEVELER, h->input_gain);
             }
-            if (window3->active && window3->adjustPosition == 0){
-                calcWindowAmplification(window3, getRmsValue(window3->sumSquare, window3->size), IS_LEVELER, h->input_gain);
-            }
-
-            if ( (window1->active && window1->adjustPosition == 0)
-              || (window2->active && window2->adjustPosition == 0)
-              || (window3->active && window3->adjustPosition == 0)
-            ) getAvgAmp(channel, window1, window2, window3);
-
-            if (window1->active) moveWindow(window1);
-            if (window2->active) moveWindow(window2);
-            if (window3->active) moveWindow(window3);
+            moveWindow(history);
         }
     }
+    if (h->meter != NULL && addMeterBlock(h->meter, h->left.out, h->right.out, samples))
+        publishMeter(h->meter, h->left.windows[0].loudness, h->right.windows[0].loudness,
+            h->left.amplification, h->right.amplification);
 }
-
-#endif
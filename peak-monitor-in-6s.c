@@ -1,25 +1,20 @@
 //  SPDX-FileCopyrightText: 2024 Milan Chrobok
 //  SPDX-License-Identifier: GPL-3.0-or-later
 
-#include "peak-monitor-plugin.c"
+#include "plugins.h"
 
-// use look ahead window, 1 = precise (delayed), 0 = instant (no delay)
-const int LOOK_AHEAD = 1;
-// long term measurement window
-const double BUFFER_DURATION1 = 6.0;
-const char *LOG_ID = "peak-in";
+static const struct PluginConfig config = {
+    // long term measurement window
+    .bufferDuration = {6.0},
+    .logId = "peak-in",
+};
 
-static LADSPA_Descriptor c_ladspa_descriptor = { .UniqueID = 0x22b307,
+const LADSPA_Descriptor peak_monitor_in_6s_descriptor = { .UniqueID = 0x22b307,
     .Label = "peak_monitor_in_6s", .Name = "peak monitor in, 6 seconds window",
     .Maker = "Milan Chrobok", .Copyright = "GPL 3",
-    .PortCount = 4, .connect_port = connect_port,
+    .PortCount = 4, .connect_port = peak_monitor_connect_port,
     .PortNames = c_port_names, .PortRangeHints = psPortRangeHints,
     .PortDescriptors = c_port_descriptors,
-    .instantiate = instantiate, .run = run, .cleanup = cleanup
+    .ImplementationData = (void*) &config,
+    .instantiate = peak_monitor_instantiate, .run = peak_monitor_run, .cleanup = peak_monitor_cleanup
 };
-
-const LADSPA_Descriptor * ladspa_descriptor(unsigned long i) {
-    if (i == 0) return &c_ladspa_descriptor;
-    return 0;
-}
-
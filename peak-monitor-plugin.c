@@ -1,18 +1,17 @@
 //  SPDX-FileCopyrightText: 2016 Milan Chrobok
 //  SPDX-License-Identifier: GPL-3.0-or-later
 
-#ifndef single_window_plugin
-#define single_window_plugin
-
+#include <stdint.h>
 #include <stdlib.h>
 #include <ladspa.h>
 #include <stdio.h>
 #include <math.h>
 #include "amplify.h"
-#include "stereo-plugin.h"
+#include "plugins.h"
+#include "monitor-log.h"
+#include "meter.h"
+#include "true-peak.h"
 
-extern const double BUFFER_DURATION1;
-extern const char *LOG_ID;
 
 struct Channel {
     LADSPA_Data *in;
@@ -21,33 +20,55 @@ struct Channel {
 
 // define our handler type
 typedef struct {
+    const struct PluginConfig* config;
     struct Channel left;
     struct Channel right;
     double peak_left;
     double peak_right;
     unsigned long rate;
     double t;
-    char *log_dir;
+    // sample frames since instantiation
+    uint64_t samples;
+    struct MonitorLog* log;
+    struct Meter* meter;
+    // true peak reports, NULL if the variant measures sample peaks only
+    struct MonitorLog* truePeakLog;
+    struct TruePeak truePeak;
 } Leveler;
 
 
-static LADSPA_Handle instantiate(const LADSPA_Descriptor *d, unsigned long rate) {
+LADSPA_Handle peak_monitor_instantiate(const LADSPA_Descriptor *d, unsigned long rate) {
     Leveler *h = calloc(1, sizeof(Leveler));
     if (h == NULL) return NULL;
+    h->config = (const struct PluginConfig*) d->ImplementationData;
     h->rate = rate;
-    h->log_dir = getenv("MONITOR_LOG_DIR");
-    if (h->log_dir == NULL)
-        h->log_dir = "/var/log/monitor";
-    setup_socket();
+    h->log = openMonitorLog(h->config->logId, h->rate);
+    if (h->log == NULL) {
+        free(h);
+        return NULL;
+    }
+    if (h->config->truePeakLogId != NULL) {
+        h->truePeakLog = openMonitorLog(h->config->truePeakLogId, h->rate);
+        if (h->truePeakLog == NULL) {
+            closeMonitorLog(h->log);
+            free(h);
+            return NULL;
+        }
+        initTruePeak(&h->truePeak);
+    }
+    h->meter = openMeter(d->Label, rate);
     return (LADSPA_Handle) h;
 }
 
-static void cleanup(LADSPA_Handle handle) {
-    free(handle);
-    close_socket();
+void peak_monitor_cleanup(LADSPA_Handle handle) {
+    Leveler *h = (Leveler*) handle;
+    closeMonitorLog(h->log);
+    closeMonitorLog(h->truePeakLog);
+    closeMeter(h->meter);
+    free(h);
 }
 
-static void connect_port(const LADSPA_Handle handle, unsigned long num,
+void peak_monitor_connect_port(const LADSPA_Handle handle, unsigned long num,
         LADSPA_Data *port) {
     Leveler *h = (Leveler*) handle;
     if (num == 0)
@@ -60,9 +81,9 @@ static void connect_port(const LADSPA_Handle handle, unsigned long num,
         h->right.out = port;
 }
 
-static void run(LADSPA_Handle handle, unsigned long samples) {
+void peak_monitor_run(LADSPA_Handle handle, unsigned long samples) {
     Leveler *h = (Leveler*) handle;
-    if (h == NULL || h->input_gain_port == NULL || samples == 0) return;
+    if (h == NULL || samples == 0) return;
     double peaks[] = { h->peak_left, h->peak_right };
     struct Channel* channels[] = {&h->left, &h->right};
     for (int c = 0; c < ARRAY_LENGTH(channels); c++) {
@@ -80,19 +101,26 @@ static void run(LADSPA_Handle handle, unsigned long samples) {
     }
     h->peak_left = peaks[0];
     h->peak_right = peaks[1];
+    if (h->truePeakLog != NULL) addTruePeak(&h->truePeak, h->left.in, h->right.in, samples);
 
+    if (h->meter != NULL && addMeterBlock(h->meter, h->left.out, h->right.out, samples))
+        publishMeter(h->meter, NAN, NAN, NAN, NAN);
     h->t += samples;
-    double limit = BUFFER_DURATION1 * h->rate;
+    h->samples += samples;
+    double limit = h->config->bufferDuration[0] * h->rate;
     if (h->t > limit) {
         h->t -= limit;
-        double l = getDb(h->peak_left);
-        double r = getDb(h->peak_right);
-        print_log(LOG_ID, l, r);
-        file_log(h->log_dir, LOG_ID, l, r);
-        send_broadcast_message(LOG_ID, l, r);
+        double l = getDbAmplitude(h->peak_left);
+        double r = getDbAmplitude(h->peak_right);
+        pushMonitorLog(h->log, MONITOR_REPORT, h->samples, l, r);
+        if (h->truePeakLog != NULL) {
+            // the sample peak is a lower bound where the filter rings below it
+            double truePeakLeft, truePeakRight;
+            readTruePeak(&h->truePeak, &truePeakLeft, &truePeakRight);
+            pushMonitorLog(h->truePeakLog, MONITOR_REPORT, h->samples,
+                getDbAmplitude(fmax(truePeakLeft, h->peak_left)), getDbAmplitude(fmax(truePeakRight, h->peak_right)));
+        }
         h->peak_left = 0.0;
         h->peak_right = 0.0;
     }
 }
-
-#endif
@@ -0,0 +1,66 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef plugins_h
+#define plugins_h
+
+// all plugin variants are bundled into rms-leveler.so,
+// each variant file defines a descriptor that refers to the entry points of its engine
+
+#include <ladspa.h>
+#include "stereo-plugin.h"
+
+#define DECLARE_ENGINE(engine) \
+    LADSPA_Handle engine##_instantiate(const LADSPA_Descriptor* d, unsigned long rate); \
+    void engine##_connect_port(const LADSPA_Handle handle, unsigned long num, LADSPA_Data* port); \
+    void engine##_run(LADSPA_Handle handle, unsigned long samples); \
+    void engine##_cleanup(LADSPA_Handle handle);
+
+DECLARE_ENGINE(single_window)
+DECLARE_ENGINE(multi_window)
+DECLARE_ENGINE(ebur_leveler)
+DECLARE_ENGINE(surround_leveler)
+DECLARE_ENGINE(rms_monitor)
+DECLARE_ENGINE(peak_monitor)
+DECLARE_ENGINE(ebur_monitor)
+
+// variants in the order of ladspa_descriptor()
+#define PLUGIN_VARIANTS(VARIANT) \
+    VARIANT(ebur128_leveler_3s) \
+    VARIANT(ebur128_leveler_3s_linked) \
+    VARIANT(ebur128_leveler_6s) \
+    VARIANT(ebur128_limiter_3s) \
+    VARIANT(ebur128_limiter_6s) \
+    VARIANT(ebur128_limiter_6s_linked) \
+    VARIANT(ebur128_monitor_in_6s) \
+    VARIANT(ebur128_monitor_out_6s) \
+    VARIANT(peak_monitor_in_6s) \
+    VARIANT(peak_monitor_out_6s) \
+    VARIANT(rms_leveler_0_3s) \
+    VARIANT(rms_leveler_1s) \
+    VARIANT(rms_leveler_3s) \
+    VARIANT(rms_leveler_3s_5_1) \
+    VARIANT(rms_leveler_3s_7_1) \
+    VARIANT(rms_leveler_3s_linked) \
+    VARIANT(rms_leveler_3s_true_peak) \
+    VARIANT(rms_leveler_6s) \
+    VARIANT(rms_leveler_6s_live) \
+    VARIANT(rms_leveler_6s_multi) \
+    VARIANT(rms_leveler_control) \
+    VARIANT(rms_limiter_0_3s) \
+    VARIANT(rms_limiter_1s) \
+    VARIANT(rms_limiter_3s) \
+    VARIANT(rms_limiter_6s) \
+    VARIANT(rms_limiter_6s_linked) \
+    VARIANT(rms_limiter_6s_multi) \
+    VARIANT(rms_limiter_6s_true_peak) \
+    VARIANT(rms_limiter_instant_1m) \
+    VARIANT(rms_monitor_in_6s) \
+    VARIANT(rms_monitor_out_6s) \
+    VARIANT(true_peak_monitor_in_6s) \
+    VARIANT(true_peak_monitor_out_6s)
+
+#define DECLARE_VARIANT(name) extern const LADSPA_Descriptor name##_descriptor;
+PLUGIN_VARIANTS(DECLARE_VARIANT)
+
+#endif
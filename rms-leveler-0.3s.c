@@ -1,26 +1,25 @@
 //  SPDX-FileCopyrightText: 2016 Milan Chrobok
 //  SPDX-License-Identifier: GPL-3.0-or-later
 
-#include "single-window-plugin.c"
+#include "plugins.h"
 
-// set 1 for leveler or 0 for limiter
-const int IS_LEVELER = 1;
-// use look ahead window, 1 = precise (delayed), 0 = instant (no delay)
-const int LOOK_AHEAD = 1;
-// long term measurement window
-const double BUFFER_DURATION1 = 0.3;
+static const struct PluginConfig config = {
+    // set 1 for leveler or 0 for limiter
+    .isLeveler = 1,
+    // use look ahead window, 1 = precise (delayed), 0 = instant (no delay)
+    .lookAhead = 1,
+    // 1 = both channels share one amplification, 0 = independent channels
+    .stereoLink = 0,
+    // long term measurement window
+    .bufferDuration = {0.3},
+};
 
-static LADSPA_Descriptor c_ladspa_descriptor = { .UniqueID = 0x22b309,
+const LADSPA_Descriptor rms_leveler_0_3s_descriptor = { .UniqueID = 0x22b309,
     .Label = "rms_leveler_0.3s", .Name = "RMS leveler, -20dBFS, 0.3 seconds window",
     .Maker = "Milan Chrobok", .Copyright = "GPL 3",
-    .PortCount = 5, .connect_port = connect_port,
+    .PortCount = 6, .connect_port = single_window_connect_port,
     .PortNames = c_port_names, .PortRangeHints = psPortRangeHints,
     .PortDescriptors = c_port_descriptors,
-    .instantiate = instantiate, .run = run, .cleanup = cleanup
+    .ImplementationData = (void*) &config,
+    .instantiate = single_window_instantiate, .run = single_window_run, .cleanup = single_window_cleanup
 };
-
-const LADSPA_Descriptor * ladspa_descriptor(unsigned long i) {
-    if (i == 0) return &c_ladspa_descriptor;
-    return 0;
-}
-
@@ -0,0 +1,27 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "plugins.h"
+
+static const struct PluginConfig config = {
+    // set 1 for leveler or 0 for limiter
+    .isLeveler = 1,
+    // use look ahead window, 1 = precise (delayed), 0 = instant (no delay)
+    .lookAhead = 1,
+    // long term measurement window
+    .bufferDuration = {3.0},
+    // FL FR FC LFE BL BR SL SR, all channels share one amplification
+    .channels = 8,
+    // channel weights of ITU-R BS.1770, LFE left out, surrounds +1.5dB
+    .channelWeight = {1.0, 1.0, 1.0, 0.0, 1.41, 1.41, 1.41, 1.41},
+};
+
+const LADSPA_Descriptor rms_leveler_3s_7_1_descriptor = { .UniqueID = 0x22b41d,
+    .Label = "rms_leveler_3s_7_1", .Name = "RMS leveler -20dBFS, 3 seconds window, 7.1 linked",
+    .Maker = "Milan Chrobok", .Copyright = "GPL 3",
+    .PortCount = PLUGIN_7_1_PORTS, .connect_port = surround_leveler_connect_port,
+    .PortNames = c_7_1_port_names, .PortRangeHints = ps7_1PortRangeHints,
+    .PortDescriptors = c_7_1_port_descriptors,
+    .ImplementationData = (void*) &config,
+    .instantiate = surround_leveler_instantiate, .run = surround_leveler_run, .cleanup = surround_leveler_cleanup
+};
@@ -0,0 +1,27 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "plugins.h"
+
+static const struct PluginConfig config = {
+    // set 1 for leveler or 0 for limiter
+    .isLeveler = 1,
+    // use look ahead window, 1 = precise (delayed), 0 = instant (no delay)
+    .lookAhead = 1,
+    // 1 = both channels share one amplification, 0 = independent channels
+    .stereoLink = 0,
+    // long term measurement window
+    .bufferDuration = {6.0},
+    // short look ahead for live programs
+    .lookAheadDelay = 0.3,
+};
+
+const LADSPA_Descriptor rms_leveler_6s_live_descriptor = { .UniqueID = 0x22b414,
+    .Label = "rms_leveler_6s_live", .Name = "RMS leveler -20dBFS, 6 seconds window, 300ms look ahead",
+    .Maker = "Milan Chrobok", .Copyright = "GPL 3",
+    .PortCount = 6, .connect_port = single_window_connect_port,
+    .PortNames = c_port_names, .PortRangeHints = psPortRangeHints,
+    .PortDescriptors = c_port_descriptors,
+    .ImplementationData = (void*) &config,
+    .instantiate = single_window_instantiate, .run = single_window_run, .cleanup = single_window_cleanup
+};
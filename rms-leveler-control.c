@@ -0,0 +1,25 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "plugins.h"
+
+static const struct PluginConfig config = {
+    // leveler or limiter by the Leveler port
+    .isLeveler = 1,
+    // use look ahead window, 1 = precise (delayed), 0 = instant (no delay)
+    .lookAhead = 1,
+    // longest window the Window port can select, the power history is allocated for it
+    .bufferDuration = {30.0},
+    // look ahead delay, fixed so the latency does not change with the window
+    .lookAheadDelay = 1.5,
+};
+
+const LADSPA_Descriptor rms_leveler_control_descriptor = { .UniqueID = 0x22b41b,
+    .Label = "rms_leveler_control", .Name = "RMS leveler, window, target, speed and mode by control ports",
+    .Maker = "Milan Chrobok", .Copyright = "GPL 3",
+    .PortCount = PLUGIN_CONTROL_PORTS, .connect_port = multi_window_connect_port,
+    .PortNames = c_control_port_names, .PortRangeHints = psControlPortRangeHints,
+    .PortDescriptors = c_control_port_descriptors,
+    .ImplementationData = (void*) &config,
+    .instantiate = multi_window_instantiate, .run = multi_window_run, .cleanup = multi_window_cleanup
+};
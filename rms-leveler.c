@@ -0,0 +1,18 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <ladspa.h>
+#include "plugins.h"
+
+#define VARIANT_DESCRIPTOR(name) &name##_descriptor,
+
+static const LADSPA_Descriptor* descriptors[] = {
+    PLUGIN_VARIANTS(VARIANT_DESCRIPTOR)
+};
+
+// the only exported symbol, the library is built with hidden visibility
+__attribute__((visibility("default")))
+const LADSPA_Descriptor * ladspa_descriptor(unsigned long i) {
+    if (i < ARRAY_LENGTH(descriptors)) return descriptors[i];
+    return 0;
+}
@@ -0,0 +1,27 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "plugins.h"
+
+static const struct PluginConfig config = {
+    // set 1 for leveler or 0 for limiter
+    .isLeveler = 0,
+    // use look ahead window, 1 = precise (delayed), 0 = instant (no delay)
+    .lookAhead = 1,
+    // 1 = both channels share one amplification, 0 = independent channels
+    .stereoLink = 0,
+    // long term measurement window
+    .bufferDuration = {6.0},
+    // true peak limiter stage with 5ms look ahead instead of the soft clip
+    .brickwallLookAhead = 0.005,
+};
+
+const LADSPA_Descriptor rms_limiter_6s_true_peak_descriptor = { .UniqueID = 0x22b41a,
+    .Label = "rms_limiter_6s_true_peak", .Name = "RMS limiter -20dBFS, 6 seconds window, true peak limited",
+    .Maker = "Milan Chrobok", .Copyright = "GPL 3",
+    .PortCount = 6, .connect_port = single_window_connect_port,
+    .PortNames = c_port_names, .PortRangeHints = psPortRangeHints,
+    .PortDescriptors = c_port_descriptors,
+    .ImplementationData = (void*) &config,
+    .instantiate = single_window_instantiate, .run = single_window_run, .cleanup = single_window_cleanup
+};
@@ -1,19 +1,16 @@
 //  SPDX-FileCopyrightText: 2016 Milan Chrobok
 //  SPDX-License-Identifier: GPL-3.0-or-later
 
-#ifndef single_window_plugin
-#define single_window_plugin
-
+#include <stdint.h>
 #include <stdlib.h>
 #include <ladspa.h>
 #include <stdio.h>
 #include <math.h>
 #include "amplify.h"
-#include "stereo-plugin.h"
+#include "plugins.h"
+#include "monitor-log.h"
+#include "meter.h"
 
-extern const int LOOK_AHEAD;
-extern const double BUFFER_DURATION1;
-extern const char *LOG_ID;
 
 struct Channel {
     LADSPA_Data* in;
@@ -23,49 +20,72 @@ struct Channel {
 
 // define our handler type
 typedef struct {
+    const struct PluginConfig* config;
     struct Channel left;
     struct Channel right;
     unsigned long rate;
     double t;
-    char *log_dir;
+    // sample frames since instantiation
+    uint64_t samples;
+    // ranges of the windows for momentary and short-term loudness, frames since their last update
+    int momentaryRange;
+    int shortTermRange;
+    unsigned long loudnessPosition;
+    struct MonitorLog* log;
+    struct Meter* meter;
 } Leveler;
 
-void destroyLeveler(Leveler *h) {
+static void destroyLeveler(Leveler *h) {
     if (h == NULL) return;
     freeWindow(&h->left.window1);
     freeWindow(&h->right.window1);
+    closeMonitorLog(h->log);
+    closeMeter(h->meter);
     free(h);
 }
 
-static LADSPA_Handle instantiate(const LADSPA_Descriptor * d, unsigned long rate) {
+LADSPA_Handle rms_monitor_instantiate(const LADSPA_Descriptor * d, unsigned long rate) {
     Leveler * h = calloc(1, sizeof(Leveler));
     if (h == NULL) return NULL;
+    h->config = (const struct PluginConfig*) d->ImplementationData;
     h->rate = rate;
     h->t = 0.;
-    h->log_dir = getenv("MONITOR_LOG_DIR");
-    if (h->log_dir == NULL)
-        h->log_dir = "/var/log/monitor";
 
-    if (!initWindow(&h->left.window1, LOOK_AHEAD, BUFFER_DURATION1, h->rate, MAX_CHANGE, ADJUST_RATE)) {
+    if (!initWindow(&h->left.window1, 0, h->config->bufferDuration[0], h->rate, MAX_CHANGE, ADJUST_RATE)) {
+        destroyLeveler(h);
+        return NULL;
+    }
+    if (!initWindow(&h->right.window1, 0, h->config->bufferDuration[0], h->rate, MAX_CHANGE, ADJUST_RATE)) {
         destroyLeveler(h);
         return NULL;
     }
-    if (!initWindow(&h->right.window1, LOOK_AHEAD, BUFFER_DURATION1, h->rate, MAX_CHANGE, ADJUST_RATE)) {
+    // both channels get the same range indexes
+    const double momentary = (double) MONITOR_MOMENTARY_BLOCKS / MONITOR_LOUDNESS_RATE;
+    const double shortTerm = (double) MONITOR_SHORT_TERM_BLOCKS / MONITOR_LOUDNESS_RATE;
+    h->momentaryRange = addWindowRange(&h->left.window1, momentary, h->rate);
+    h->shortTermRange = addWindowRange(&h->left.window1, shortTerm, h->rate);
+    if (h->momentaryRange < 0 || h->shortTermRange < 0
+            || addWindowRange(&h->right.window1, momentary, h->rate) != h->momentaryRange
+            || addWindowRange(&h->right.window1, shortTerm, h->rate) != h->shortTermRange) {
         destroyLeveler(h);
         return NULL;
     }
 
-    setup_socket();
+    h->meter = openMeter(d->Label, rate);
+    h->log = openMonitorLog(h->config->logId, h->rate);
+    if (h->log == NULL) {
+        destroyLeveler(h);
+        return NULL;
+    }
     return (LADSPA_Handle) h;
 }
 
-static void cleanup(LADSPA_Handle handle) {
+void rms_monitor_cleanup(LADSPA_Handle handle) {
     Leveler * h = (Leveler *) handle;
     destroyLeveler(h);
-    close_socket();
 }
 
-static void connect_port(const LADSPA_Handle handle, unsigned long num, LADSPA_Data * port) {
+void rms_monitor_connect_port(const LADSPA_Handle handle, unsigned long num, LADSPA_Data * port) {
     Leveler * h = (Leveler *) handle;
     if (num == 0)   h->left.in = port;
     if (num == 1)  h->right.in = port;
@@ -73,36 +93,61 @@ static void connect_port(const LADSPA_Handle handle, unsigned long num, LADSPA_D
     if (num == 3) h->right.out = port;
 }
 
-static void run(LADSPA_Handle handle, unsigned long samples) {
+// momentary and short-term loudness from the block sums of the window, at the given frame since instantiation
+static void updateLoudness(Leveler* h, uint64_t position) {
+    double momentary[] = {
+        getWindowRangeLoudness(&h->left.window1, h->momentaryRange),
+        getWindowRangeLoudness(&h->right.window1, h->momentaryRange)
+    };
+    double shortTerm[] = {
+        getWindowRangeLoudness(&h->left.window1, h->shortTermRange),
+        getWindowRangeLoudness(&h->right.window1, h->shortTermRange)
+    };
+    pushMonitorLog(h->log, MONITOR_MOMENTARY, position, momentary[0], momentary[1]);
+    pushMonitorLog(h->log, MONITOR_SHORT_TERM, position, shortTerm[0], shortTerm[1]);
+    if (h->meter != NULL) setMeterLoudness(h->meter, momentary, shortTerm);
+}
+
+void rms_monitor_run(LADSPA_Handle handle, unsigned long samples) {
     Leveler * h = (Leveler *) handle;
-    if (h == NULL || h->input_gain_port == NULL || samples == 0) return;
+    if (h == NULL || samples == 0) return;
 
+    // process in slices up to the next 100ms boundary, so blocks longer than that update the loudness at each boundary
     struct Channel* channels[] = {&h->left, &h->right};
-    for (int c = 0; c < ARRAY_LENGTH(channels); c++) {
-        struct Channel* channel = channels[c];
-        if (channel->in == NULL || channel->out == NULL) continue;
-        struct Window* window1 = &channel->window1;
-
-        for (unsigned long s = 0; s < samples; s++) {
-            LADSPA_Data input = (channel == NULL) ? 0 : channel->in[s];
-            prepareWindow(window1);
-            addWindowData(window1, input);
-            sumWindowData(window1);
-            if (channel->out != NULL) channel->out[s] = (LADSPA_Data) input;
-            moveWindow(window1);
+    unsigned long interval = h->rate / MONITOR_LOUDNESS_RATE;
+    for (unsigned long s = 0; s < samples;) {
+        unsigned long end = s + interval - h->loudnessPosition;
+        if (end > samples) end = samples;
+        for (int c = 0; c < ARRAY_LENGTH(channels); c++) {
+            struct Channel* channel = channels[c];
+            if (channel->in == NULL || channel->out == NULL) continue;
+            struct Window* window1 = &channel->window1;
+
+            for (unsigned long i = s; i < end; i++) {
+                LADSPA_Data input = channel->in[i];
+                prepareWindow(window1);
+                addWindowData(window1, input);
+                sumWindowData(window1, input);
+                channel->out[i] = (LADSPA_Data) input;
+                moveWindow(window1);
+            }
         }
+        h->loudnessPosition += end - s;
+        s = end;
+        if (h->loudnessPosition < interval) continue;
+        h->loudnessPosition = 0;
+        updateLoudness(h, h->samples + s);
     }
 
+    if (h->meter != NULL && addMeterBlock(h->meter, h->left.out, h->right.out, samples))
+        publishMeter(h->meter, getWindowLoudness(&h->left.window1), getWindowLoudness(&h->right.window1), NAN, NAN);
     h->t += samples;
-    double limit = BUFFER_DURATION1 * h->rate;
+    h->samples += samples;
+    double limit = h->config->bufferDuration[0] * h->rate;
     if (h->t > limit) {
         h->t -= limit;
-        double rms_left  = getRmsValue(h->left.window1.sumSquare,  h->left.window1.size);
-        double rms_right = getRmsValue(h->right.window1.sumSquare, h->right.window1.size);
-        print_log(LOG_ID, rms_left, rms_right);
-        file_log(h->log_dir, LOG_ID, rms_left, rms_right);
-        send_broadcast_message(LOG_ID, rms_left, rms_right);
+        double rms_left  = getWindowLoudness(&h->left.window1);
+        double rms_right = getWindowLoudness(&h->right.window1);
+        pushMonitorLog(h->log, MONITOR_REPORT, h->samples, rms_left, rms_right);
     }
 }
-
-#endif
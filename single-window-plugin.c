@@ -1,19 +1,16 @@
 //  SPDX-FileCopyrightText: 2016 Milan Chrobok
 //  SPDX-License-Identifier: GPL-3.0-or-later
 
-#ifndef single_window_plugin
-#define single_window_plugin
-
 #include <stdlib.h>
 #include <ladspa.h>
 #include <stdio.h>
 #include <math.h>
 #include "amplify.h"
-#include "stereo-plugin.h"
+#include "kernel.h"
+#include "brickwall.h"
+#include "plugins.h"
+#include "meter.h"
 
-extern const int IS_LEVELER;
-extern const int LOOK_AHEAD;
-extern const double BUFFER_DURATION1;
 
 struct Channel {
     LADSPA_Data* in;
@@ -26,35 +23,96 @@ struct Channel {
     struct Window window1;
     struct Window window2;
     struct Window window3;
+    struct Brickwall brickwall;
 };
 
 // define our handler type
-typedef struct {
+typedef struct Leveler Leveler;
+typedef void (*RunFunction)(Leveler* h, unsigned long samples);
+
+struct Leveler {
+    const struct PluginConfig* config;
+    RunFunction process;
     struct Channel left;
     struct Channel right;
     unsigned long rate;
     double input_gain;
     LADSPA_Data* input_gain_port;
-} Leveler;
+    LADSPA_Data* latency_port;
+    ChunkKernel kernel;
+    LinkedChunkKernel linkedKernel;
+    // interleaved stereo window for linked mode
+    struct Window linked;
+    struct Brickwall linkedBrickwall;
+    struct Meter* meter;
+};
 
-void destroyLeveler(Leveler *h) {
+static void destroyLeveler(Leveler *h) {
     if (h == NULL) return;
     freeWindow(&h->left.window1);
     freeWindow(&h->right.window1);
+    freeWindow(&h->linked);
+    freeBrickwall(&h->left.brickwall);
+    freeBrickwall(&h->right.brickwall);
+    freeBrickwall(&h->linkedBrickwall);
+    closeMeter(h->meter);
     free(h);
 }
 
-static LADSPA_Handle instantiate(const LADSPA_Descriptor * d, unsigned long rate) {
+static RunFunction selectRun(const struct PluginConfig* config);
+
+// the true peak stage reads its look ahead from the ring of the window, so the window has to play back at least that late,
+// the block kernels only soft clip, so it runs on the per sample path
+static int initWindowBrickwall(Leveler* h, struct Brickwall* brickwall, struct Window* window) {
+    if (!initBrickwall(brickwall, window->channels, h->config->brickwallLookAhead, h->rate)) return 0;
+    if (window->data == NULL || window->delay < brickwall->delay) return 0;
+    h->kernel = NULL;
+    h->linkedKernel = NULL;
+    return 1;
+}
+
+LADSPA_Handle single_window_instantiate(const LADSPA_Descriptor * d, unsigned long rate) {
+    const struct PluginConfig* config = (const struct PluginConfig*) d->ImplementationData;
     Leveler * h = calloc(1, sizeof(Leveler));
     if (h == NULL) return NULL;
+    h->config = config;
+    h->process = selectRun(config);
     h->rate = rate;
     h->input_gain = 1.0;
+    h->kernel = getChunkKernel(config->lookAhead);
+    h->linkedKernel = getLinkedChunkKernel(config->lookAhead);
+    h->meter = openMeter(d->Label, rate);
 
-    if (!initWindow(&h->left.window1, LOOK_AHEAD, BUFFER_DURATION1, h->rate, MAX_CHANGE, ADJUST_RATE)) {
+    if (config->stereoLink) {
+        if (!initWindowChannels(&h->linked, 2, config->lookAhead, config->bufferDuration[0], h->rate, MAX_CHANGE, ADJUST_RATE)) {
+            destroyLeveler(h);
+            return NULL;
+        }
+        if (config->lookAheadDelay > 0 && !setWindowDelay(&h->linked, config->lookAheadDelay, h->rate)) {
+            destroyLeveler(h);
+            return NULL;
+        }
+        if (config->brickwallLookAhead > 0 && !initWindowBrickwall(h, &h->linkedBrickwall, &h->linked)) {
+            destroyLeveler(h);
+            return NULL;
+        }
+        return (LADSPA_Handle) h;
+    }
+    if (!initWindow(&h->left.window1, config->lookAhead, config->bufferDuration[0], h->rate, MAX_CHANGE, ADJUST_RATE)) {
         destroyLeveler(h);
         return NULL;
     }
-    if (!initWindow(&h->right.window1, LOOK_AHEAD, BUFFER_DURATION1, h->rate, MAX_CHANGE, ADJUST_RATE)) {
+    if (!initWindow(&h->right.window1, config->lookAhead, config->bufferDuration[0], h->rate, MAX_CHANGE, ADJUST_RATE)) {
+        destroyLeveler(h);
+        return NULL;
+    }
+    if (config->lookAheadDelay > 0 && (!setWindowDelay(&h->left.window1, config->lookAheadDelay, h->rate)
+            || !setWindowDelay(&h->right.window1, config->lookAheadDelay, h->rate))) {
+        destroyLeveler(h);
+        return NULL;
+    }
+    if (config->brickwallLookAhead > 0 && (!initWindowBrickwall(h, &h->left.brickwall, &h->left.window1)
+            || !initWindowBrickwall(h, &h->right.brickwall, &h->right.window1))) {
         destroyLeveler(h);
         return NULL;
     }
@@ -62,53 +120,119 @@ static LADSPA_Handle instantiate(const LADSPA_Descriptor * d, unsigned long rate
     return (LADSPA_Handle) h;
 }
 
-static void cleanup(LADSPA_Handle handle) {
+void single_window_cleanup(LADSPA_Handle handle) {
     Leveler * h = (Leveler *) handle;
     destroyLeveler(h);
 }
 
-static void connect_port(const LADSPA_Handle handle, unsigned long num, LADSPA_Data *port) {
+void single_window_connect_port(const LADSPA_Handle handle, unsigned long num, LADSPA_Data *port) {
     Leveler * h = (Leveler *) handle;
     if (num == 0) h->left.in = port;
     if (num == 1) h->right.in = port;
     if (num == 2) h->left.out = port;
     if (num == 3) h->right.out = port;
     if (num == 4) h->input_gain_port = port;
+    if (num == PLUGIN_LATENCY_PORT) h->latency_port = port;
 }
 
-static void run(LADSPA_Handle handle, unsigned long samples) {
-    Leveler * h = (Leveler *) handle;
-    if (h == NULL || h->input_gain_port == NULL || samples == 0) return;
-    struct Channel* channels[] = {&h->left, &h->right};
-    h->input_gain = pow(10.0, *(h->input_gain_port) / 20.0);
-    for (int c = 0; c < ARRAY_LENGTH(channels); c++) {
-        struct Channel* channel = channels[c];
-        if (channel->in == NULL || channel->out == NULL) continue;
-        struct Window* window1 = &channel->window1;
+// process both channels in one pass with one amplification from the power of both channels
+static inline __attribute__((always_inline))
+void runLinked(Leveler* h, unsigned long samples, const int isLeveler, const int lookAhead, const int brickwall) {
+    struct Window* window = &h->linked;
+    struct Channel* left = &h->left;
+    struct Channel* right = &h->right;
+    if (left->in == NULL || left->out == NULL || right->in == NULL || right->out == NULL) return;
+
+    for (unsigned long s = 0; s < samples;) {
+        unsigned long n = (h->linkedKernel == NULL) ? 0 : getChunkSize(window, samples - s);
+        if (n > 0 && h->linkedKernel(window, left->in + s, right->in + s, left->out + s, right->out + s, n,
+                h->input_gain, window->amplification, window->oldAmplification) == n) {
+            s += n;
+            continue;
+        }
+        unsigned long end = s + ((n > 0) ? n : 1);
+        for (; s < end; s++) {
+            LADSPA_Data inputLeft = left->in[s] * h->input_gain;
+            LADSPA_Data inputRight = right->in[s] * h->input_gain;
+            prepareWindow(window);
+            addWindowFrame(window, inputLeft, inputRight);
+            sumWindowFrame(window, inputLeft, inputRight);
+            double ampFactor = interpolateAmplification(window, window->amplification, window->oldAmplification);
+            double valueLeft = inputLeft;
+            double valueRight = inputRight;
+            if (lookAhead) {
+                valueLeft = window->data[2 * window->playPosition] - getWindowChannelDcOffset(window, 0);
+                valueRight = window->data[2 * window->playPosition + 1] - getWindowChannelDcOffset(window, 1);
+            }
+            if (brickwall) {
+                struct Brickwall* stage = &h->linkedBrickwall;
+                LADSPA_Data ahead[] = {
+                    getWindowAhead(window, stage->delay, 0), getWindowAhead(window, stage->delay, 1)
+                };
+                double amplification = (window->amplification > window->oldAmplification)
+                    ? window->amplification : window->oldAmplification;
+                double gain = runBrickwall(stage, ahead, amplification);
+                gain = (ampFactor < gain) ? ampFactor : gain;
+                left->out[s] = (LADSPA_Data) clipBrickwall(gain * valueLeft);
+                right->out[s] = (LADSPA_Data) clipBrickwall(gain * valueRight);
+            } else {
+                left->out[s] = (LADSPA_Data) limit(ampFactor * valueLeft);
+                right->out[s] = (LADSPA_Data) limit(ampFactor * valueRight);
+            }
+#ifdef DEBUG
+            printWindow(window, 1);
+#endif
+            if (window->adjustPosition == 0)
+                calcWindowAmplification(window, getWindowLoudness(window), isLeveler, h->input_gain);
+            moveWindow(window);
+        }
+    }
+}
+
+static inline __attribute__((always_inline))
+void runChannel(Leveler* h, struct Channel* channel, unsigned long samples, const int isLeveler, const int lookAhead,
+        const int brickwall) {
+    if (channel->in == NULL || channel->out == NULL) return;
+    struct Window* window1 = &channel->window1;
 
-        for (unsigned long s = 0; s < samples; s++) {
-            LADSPA_Data input = (channel == NULL) ? 0 : channel->in[s] * h->input_gain;
+    for (unsigned long s = 0; s < samples;) {
+        // process runs of samples without wrap or adjust point by the block kernel,
+        // fall back to per sample processing if the kernel rejects the run
+        unsigned long n = (h->kernel == NULL) ? 0 : getChunkSize(window1, samples - s);
+        if (n > 0 && h->kernel(window1, channel->in + s, channel->out + s, n, h->input_gain,
+                channel->amplification, channel->oldAmplification) == n) {
+            s += n;
+            continue;
+        }
+        unsigned long end = s + ((n > 0) ? n : 1);
+        for (; s < end; s++) {
+            LADSPA_Data input = channel->in[s] * h->input_gain;
             prepareWindow(window1);
             addWindowData(window1, input);
-            sumWindowData(window1);
+            sumWindowData(window1, input);
             // interpolate with shifted adjust position
-            double ampFactor = interpolateAmplification(channel->amplification, channel->oldAmplification,
-                window1->adjustPosition, window1->adjustRate);
+            double ampFactor = interpolateAmplification(window1, channel->amplification, channel->oldAmplification);
             // read from playPosition, amplify and limit
             double value =
-                (LOOK_AHEAD == 1)
+                lookAhead
                 ? window1->data[window1->playPosition] - getWindowDcOffset(window1)
                 : input;
-            value = limit(ampFactor * value);
-            if (channel->out != NULL) {
-                channel->out[s] = (LADSPA_Data) value;
+            if (brickwall) {
+                LADSPA_Data ahead = getWindowAhead(window1, channel->brickwall.delay, 0);
+                double amplification = (channel->amplification > channel->oldAmplification)
+                    ? channel->amplification : channel->oldAmplification;
+                double gain = runBrickwall(&channel->brickwall, &ahead, amplification);
+                value = clipBrickwall(((ampFactor < gain) ? ampFactor : gain) * value);
+            } else {
+                value = limit(ampFactor * value);
             }
+            channel->out[s] = (LADSPA_Data) value;
 #ifdef DEBUG
-            printWindow(window1, c==ARRAY_LENGTH(channels)-1);
+            printWindow(window1, channel == &h->right);
 #endif
 
             if (window1->adjustPosition == 0)
-                calcWindowAmplification(window1, getRmsValue(window1->sumSquare, window1->size), IS_LEVELER, h->input_gain);
+                calcWindowAmplification(window1, getWindowLoudness(window1), isLeveler, h->input_gain);
             channel->amplification    = window1->amplification;
             channel->oldAmplification = window1->oldAmplification;
             moveWindow(window1);
@@ -116,4 +240,53 @@ static void run(LADSPA_Handle handle, unsigned long samples) {
     }
 }
 
-#endif
+// stamp out a run function without mode tests in the sample loop for each mode, look ahead, final stage and window layout
+#define DEFINE_RUN(name, isLeveler, lookAhead, brickwall) \
+    static void name(Leveler* h, unsigned long samples) { \
+        runChannel(h, &h->left, samples, isLeveler, lookAhead, brickwall); \
+        runChannel(h, &h->right, samples, isLeveler, lookAhead, brickwall); \
+    } \
+    static void name##Linked(Leveler* h, unsigned long samples) { \
+        runLinked(h, samples, isLeveler, lookAhead, brickwall); \
+    }
+
+DEFINE_RUN(runLevelerLookAhead, 1, 1, 0)
+DEFINE_RUN(runLevelerInstant,   1, 0, 0)
+DEFINE_RUN(runLimiterLookAhead, 0, 1, 0)
+DEFINE_RUN(runLimiterInstant,   0, 0, 0)
+// the true peak stage needs look ahead
+DEFINE_RUN(runLevelerBrickwall, 1, 1, 1)
+DEFINE_RUN(runLimiterBrickwall, 0, 1, 1)
+
+static RunFunction selectRun(const struct PluginConfig* config) {
+    if (config->brickwallLookAhead > 0) {
+        static const RunFunction brickwallRuns[2][2] = {
+            { runLimiterBrickwall, runLimiterBrickwallLinked },
+            { runLevelerBrickwall, runLevelerBrickwallLinked },
+        };
+        return brickwallRuns[config->isLeveler != 0][config->stereoLink != 0];
+    }
+    static const RunFunction runs[2][2][2] = {
+        { { runLimiterInstant,   runLimiterInstantLinked   },
+          { runLimiterLookAhead, runLimiterLookAheadLinked } },
+        { { runLevelerInstant,   runLevelerInstantLinked   },
+          { runLevelerLookAhead, runLevelerLookAheadLinked } },
+    };
+    return runs[config->isLeveler != 0][config->lookAhead != 0][config->stereoLink != 0];
+}
+
+void single_window_run(LADSPA_Handle handle, unsigned long samples) {
+    Leveler * h = (Leveler *) handle;
+    if (h == NULL || h->input_gain_port == NULL || samples == 0) return;
+    h->input_gain = pow(10.0, *(h->input_gain_port) / 20.0);
+    if (h->latency_port != NULL)
+        *(h->latency_port) = (LADSPA_Data) (h->config->stereoLink ? h->linked.delay : h->left.window1.delay);
+    h->process(h, samples);
+    if (h->meter != NULL && addMeterBlock(h->meter, h->left.out, h->right.out, samples)) {
+        if (h->config->stereoLink)
+            publishMeter(h->meter, h->linked.loudness, h->linked.loudness, h->linked.amplification, h->linked.amplification);
+        else
+            publishMeter(h->meter, h->left.window1.loudness, h->right.window1.loudness,
+                h->left.amplification, h->right.amplification);
+    }
+}
@@ -0,0 +1,185 @@
+//  SPDX-FileCopyrightText: 2016 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stereo-plugin.h"
+
+const char* const c_port_names[6] = {
+    "Left In",
+    "Right In",
+    "Left Out",
+    "Right Out",
+    "Input Gain",
+    "latency"
+};
+
+const LADSPA_PortDescriptor c_port_descriptors[6] = {
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_CONTROL | LADSPA_PORT_INPUT,
+    LADSPA_PORT_CONTROL | LADSPA_PORT_OUTPUT
+};
+
+const LADSPA_PortRangeHint psPortRangeHints[6] = {
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = LADSPA_HINT_BOUNDED_BELOW | LADSPA_HINT_BOUNDED_ABOVE | LADSPA_HINT_DEFAULT_0, .LowerBound = -24.0, .UpperBound = 24.0 },
+    { .HintDescriptor = LADSPA_HINT_INTEGER, .LowerBound = 0, .UpperBound = 0 }
+};
+
+const char* const c_control_port_names[PLUGIN_CONTROL_PORTS] = {
+    "Left In",
+    "Right In",
+    "Left Out",
+    "Right Out",
+    "Input Gain",
+    "latency",
+    "Window (s)",
+    "Target (dB)",
+    "Max Change (per s)",
+    "Leveler"
+};
+
+const LADSPA_PortDescriptor c_control_port_descriptors[PLUGIN_CONTROL_PORTS] = {
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_CONTROL | LADSPA_PORT_INPUT,
+    LADSPA_PORT_CONTROL | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_CONTROL | LADSPA_PORT_INPUT,
+    LADSPA_PORT_CONTROL | LADSPA_PORT_INPUT,
+    LADSPA_PORT_CONTROL | LADSPA_PORT_INPUT,
+    LADSPA_PORT_CONTROL | LADSPA_PORT_INPUT
+};
+
+// the logarithmic middles are the defaults of the fixed variants: 3s window and 0.7 per second
+const LADSPA_PortRangeHint psControlPortRangeHints[PLUGIN_CONTROL_PORTS] = {
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = LADSPA_HINT_BOUNDED_BELOW | LADSPA_HINT_BOUNDED_ABOVE | LADSPA_HINT_DEFAULT_0, .LowerBound = -24.0, .UpperBound = 24.0 },
+    { .HintDescriptor = LADSPA_HINT_INTEGER, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = LADSPA_HINT_BOUNDED_BELOW | LADSPA_HINT_BOUNDED_ABOVE | LADSPA_HINT_LOGARITHMIC | LADSPA_HINT_DEFAULT_MIDDLE, .LowerBound = 0.3, .UpperBound = 30.0 },
+    { .HintDescriptor = LADSPA_HINT_BOUNDED_BELOW | LADSPA_HINT_BOUNDED_ABOVE | LADSPA_HINT_DEFAULT_MIDDLE, .LowerBound = -40.0, .UpperBound = 0.0 },
+    { .HintDescriptor = LADSPA_HINT_BOUNDED_BELOW | LADSPA_HINT_BOUNDED_ABOVE | LADSPA_HINT_LOGARITHMIC | LADSPA_HINT_DEFAULT_MIDDLE, .LowerBound = 0.07, .UpperBound = 7.0 },
+    { .HintDescriptor = LADSPA_HINT_TOGGLED | LADSPA_HINT_DEFAULT_1, .LowerBound = 0, .UpperBound = 0 }
+};
+
+const char* const c_5_1_port_names[PLUGIN_5_1_PORTS] = {
+    "Front Left In",
+    "Front Right In",
+    "Center In",
+    "LFE In",
+    "Back Left In",
+    "Back Right In",
+    "Front Left Out",
+    "Front Right Out",
+    "Center Out",
+    "LFE Out",
+    "Back Left Out",
+    "Back Right Out",
+    "Input Gain",
+    "latency"
+};
+
+const LADSPA_PortDescriptor c_5_1_port_descriptors[PLUGIN_5_1_PORTS] = {
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_CONTROL | LADSPA_PORT_INPUT,
+    LADSPA_PORT_CONTROL | LADSPA_PORT_OUTPUT
+};
+
+const LADSPA_PortRangeHint ps5_1PortRangeHints[PLUGIN_5_1_PORTS] = {
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = LADSPA_HINT_BOUNDED_BELOW | LADSPA_HINT_BOUNDED_ABOVE | LADSPA_HINT_DEFAULT_0, .LowerBound = -24.0, .UpperBound = 24.0 },
+    { .HintDescriptor = LADSPA_HINT_INTEGER, .LowerBound = 0, .UpperBound = 0 }
+};
+
+const char* const c_7_1_port_names[PLUGIN_7_1_PORTS] = {
+    "Front Left In",
+    "Front Right In",
+    "Center In",
+    "LFE In",
+    "Back Left In",
+    "Back Right In",
+    "Side Left In",
+    "Side Right In",
+    "Front Left Out",
+    "Front Right Out",
+    "Center Out",
+    "LFE Out",
+    "Back Left Out",
+    "Back Right Out",
+    "Side Left Out",
+    "Side Right Out",
+    "Input Gain",
+    "latency"
+};
+
+const LADSPA_PortDescriptor c_7_1_port_descriptors[PLUGIN_7_1_PORTS] = {
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
+    LADSPA_PORT_CONTROL | LADSPA_PORT_INPUT,
+    LADSPA_PORT_CONTROL | LADSPA_PORT_OUTPUT
+};
+
+const LADSPA_PortRangeHint ps7_1PortRangeHints[PLUGIN_7_1_PORTS] = {
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
+    { .HintDescriptor = LADSPA_HINT_BOUNDED_BELOW | LADSPA_HINT_BOUNDED_ABOVE | LADSPA_HINT_DEFAULT_0, .LowerBound = -24.0, .UpperBound = 24.0 },
+    { .HintDescriptor = LADSPA_HINT_INTEGER, .LowerBound = 0, .UpperBound = 0 }
+};
@@ -1,134 +1,72 @@
 //  SPDX-FileCopyrightText: 2016 Milan Chrobok
 //  SPDX-License-Identifier: GPL-3.0-or-later
 
-#include <time.h>
-#include <stdio.h>
-#include <errno.h>
-#include <string.h>
-#include <sys/socket.h>
-#include <arpa/inet.h>
-#include <netinet/in.h>
-#include <unistd.h>
-#include <pthread.h>
+#ifndef stereo_plugin_h
+#define stereo_plugin_h
+
+#include <ladspa.h>
 
 #define ARRAY_LENGTH(arr) (sizeof(arr) / sizeof((arr)[0]))
 #define BROADCAST_ADDRESS "127.0.0.1"
 #define BROADCAST_PORT 65432
-
-static const char * c_port_names[5] = {
-    "Left In",
-    "Right In",
-    "Left Out",
-    "Right Out",
-    "Input Gain"
-};
-
-static LADSPA_PortDescriptor c_port_descriptors[5] = {
-    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
-    LADSPA_PORT_AUDIO | LADSPA_PORT_INPUT,
-    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
-    LADSPA_PORT_AUDIO | LADSPA_PORT_OUTPUT,
-    LADSPA_PORT_CONTROL | LADSPA_PORT_INPUT
+// maximum number of measurement windows of a variant
+#define PLUGIN_MAX_WINDOWS 4
+// maximum number of audio channels of a multichannel variant
+#define PLUGIN_MAX_CHANNELS 8
+
+// variant configuration, passed as ImplementationData of the descriptor
+struct PluginConfig {
+    // set 1 for leveler or 0 for limiter
+    int isLeveler;
+    // use look ahead window, 1 = precise (delayed), 0 = instant (no delay)
+    int lookAhead;
+    // 1 = both channels share one amplification, 0 = independent channels
+    int stereoLink;
+    // measurement windows in seconds, 0 = unused
+    double bufferDuration[PLUGIN_MAX_WINDOWS];
+    // weight of each window in the amplification of multi window variants, all 0 = equal weights
+    double bufferWeight[PLUGIN_MAX_WINDOWS];
+    // look ahead delay in seconds, 0 = half of the first measurement window
+    double lookAheadDelay;
+    // look ahead of the true peak limiter stage in seconds, read from the look ahead delay, 0 = soft clip by limit()
+    double brickwallLookAhead;
+    // audio channels of multichannel variants, 0 = stereo
+    int channels;
+    // weight of the power of each channel in the linked loudness of multichannel variants
+    double channelWeight[PLUGIN_MAX_CHANNELS];
+    // name of a monitor in log files and broadcast messages
+    const char* logId;
+    // name of the true peak reports of a peak monitor, NULL = sample peak only
+    const char* truePeakLogId;
 };
 
-static const LADSPA_PortRangeHint psPortRangeHints[5] = {
-    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
-    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
-    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
-    { .HintDescriptor = 0, .LowerBound = 0, .UpperBound = 0 },
-    { .HintDescriptor = LADSPA_HINT_BOUNDED_BELOW | LADSPA_HINT_BOUNDED_ABOVE | LADSPA_HINT_DEFAULT_0, .LowerBound = -24.0, .UpperBound = 24.0 }
-};
-
-void print_log(const char* LOG_ID, double l, double r) {
-    time_t now;
-    time(&now);
-    struct tm *localTime = localtime(&now);
-    char formattedTime[20];
-    strftime(formattedTime, sizeof(formattedTime), "%Y-%m-%d %H:%M:%S",
-            localTime);
-    fprintf(stderr, "%s %s\t%2.3f\t%2.3f\n", formattedTime, LOG_ID, l, r);
-}
-
-void file_log(char* log_dir, const char* LOG_ID, double l, double r) {
-    time_t now;
-    time(&now);
-    struct tm *localTime = localtime(&now);
-    char formattedTime[20];
-    strftime(formattedTime, sizeof(formattedTime), "%Y-%m-%d %H:%M:%S",
-            localTime);
-
-    char formattedDate[11];
-    strftime(formattedDate, sizeof(formattedDate), "%Y-%m-%d", localTime);
-
-    char path[256];
-    snprintf(path, sizeof(path), "%s/%s-monitor-%s.log", log_dir,
-            formattedDate, LOG_ID);
-    FILE *log_file = fopen(path, "a");
-    if (log_file == NULL) {
-        fprintf(stderr, "%s Failed to open log file %s: %s.\n",
-                formattedTime, path, strerror(errno));
-        return;
-    }
-    fprintf(log_file, "%s\t%2.3f\t%2.3f\n", formattedTime, l, r);
-    fclose(log_file);
-}
-
-static int broadcast_socket = -1;
-static struct sockaddr_in broadcast_addr;
-static pthread_mutex_t broadcast_mutex = PTHREAD_MUTEX_INITIALIZER;
-
-void setup_socket() {
-    if (broadcast_socket >= 0) return;
-    pthread_mutex_lock(&broadcast_mutex);
-    broadcast_socket = socket(AF_INET, SOCK_DGRAM, 0);
-    if (broadcast_socket < 0) {
-        fprintf(stderr, "Error creating broadcast socket: %s\n", strerror(errno));
-        broadcast_socket = -1;
-        pthread_mutex_unlock(&broadcast_mutex);
-        return;
-    }
-
-    int broadcast_enable = 1;
-    if (setsockopt(broadcast_socket, SOL_SOCKET, SO_BROADCAST, &broadcast_enable, sizeof(broadcast_enable)) < 0) {
-        fprintf(stderr, "Error enabling broadcast: %s\n", strerror(errno));
-        close(broadcast_socket);
-        broadcast_socket = -1;
-        pthread_mutex_unlock(&broadcast_mutex);
-        return;
-    }
-    memset(&broadcast_addr, 0, sizeof(broadcast_addr));
-    broadcast_addr.sin_family = AF_INET;
-    broadcast_addr.sin_port = htons(BROADCAST_PORT);
-    broadcast_addr.sin_addr.s_addr = inet_addr(BROADCAST_ADDRESS);
-    pthread_mutex_unlock(&broadcast_mutex);
-}
-
-void send_broadcast_message(const char *filename, double l, double r) {
-    if (broadcast_socket < 0) return;
-    time_t now;
-    time(&now);
-    struct tm *localTime = localtime(&now);
-    char formattedTime[20];
-    strftime(formattedTime, sizeof(formattedTime), "%Y-%m-%d %H:%M:%S",
-            localTime);
-
-    char broadcast_message[256];
-    snprintf(broadcast_message, sizeof(broadcast_message),
-        "%s\t%s\t%2.3f\t%2.3f\n",
-        formattedTime, filename, l, r
-    );
-
-    pthread_mutex_lock(&broadcast_mutex);
-    ssize_t bytes_sent = sendto(broadcast_socket, broadcast_message, strlen(broadcast_message), MSG_DONTWAIT,
-                                (struct sockaddr*)&broadcast_addr, sizeof(broadcast_addr));
-    pthread_mutex_unlock(&broadcast_mutex);
-    if (bytes_sent < 0) fprintf(stderr, "Error sending broadcast message: %s\n", strerror(errno));
-}
-
-void close_socket() {
-    if (broadcast_socket < 0) return;
-    pthread_mutex_lock(&broadcast_mutex);
-    close(broadcast_socket);
-    broadcast_socket = -1;
-    pthread_mutex_unlock(&broadcast_mutex);
-}
+// ports shared by all variants, monitors use the first 4,
+// levelers and limiters report their look ahead delay in frames on the latency port
+#define PLUGIN_LATENCY_PORT 5
+extern const char* const c_port_names[6];
+extern const LADSPA_PortDescriptor c_port_descriptors[6];
+extern const LADSPA_PortRangeHint psPortRangeHints[6];
+
+// control ports of the configurable variants, after the shared ports,
+// read in every run(), the window is bounded by the first measurement window of the variant
+#define PLUGIN_WINDOW_PORT 6
+#define PLUGIN_TARGET_PORT 7
+#define PLUGIN_MAX_CHANGE_PORT 8
+#define PLUGIN_LEVELER_PORT 9
+#define PLUGIN_CONTROL_PORTS 10
+extern const char* const c_control_port_names[PLUGIN_CONTROL_PORTS];
+extern const LADSPA_PortDescriptor c_control_port_descriptors[PLUGIN_CONTROL_PORTS];
+extern const LADSPA_PortRangeHint psControlPortRangeHints[PLUGIN_CONTROL_PORTS];
+
+// ports of the multichannel variants: the inputs, the outputs, Input Gain and latency,
+// channels in the order of ffmpeg: FL FR FC LFE BL BR for 5.1, followed by SL SR for 7.1
+#define PLUGIN_5_1_PORTS 14
+#define PLUGIN_7_1_PORTS 18
+extern const char* const c_5_1_port_names[PLUGIN_5_1_PORTS];
+extern const LADSPA_PortDescriptor c_5_1_port_descriptors[PLUGIN_5_1_PORTS];
+extern const LADSPA_PortRangeHint ps5_1PortRangeHints[PLUGIN_5_1_PORTS];
+extern const char* const c_7_1_port_names[PLUGIN_7_1_PORTS];
+extern const LADSPA_PortDescriptor c_7_1_port_descriptors[PLUGIN_7_1_PORTS];
+extern const LADSPA_PortRangeHint ps7_1PortRangeHints[PLUGIN_7_1_PORTS];
+
+#endif
@@ -0,0 +1,241 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <stdlib.h>
+#include <ladspa.h>
+#include <stdio.h>
+#include <math.h>
+#include "amplify.h"
+#include "kernel.h"
+#include "plugins.h"
+#include "meter.h"
+
+// Leveler for multichannel feeds with one amplification for all channels.
+//
+// All channels share one window, its ring holds the interleaved frames for the look ahead
+// and its power history the channel weighted power of each frame. Runs of samples without
+// adjust point, block boundary or wrap are processed as chunks like in kernel.h: the
+// amplification ramp of the chunk is evaluated once for all channels, then each channel
+// is processed over its contiguous ports, so the cost per channel is the sample loop only.
+// Ports are the inputs, the outputs, Input Gain and latency, the channel order is that of the variant.
+
+// define our handler type
+typedef struct Surround Surround;
+typedef void (*RunFunction)(Surround* h, unsigned long samples);
+
+struct Surround {
+    const struct PluginConfig* config;
+    RunFunction process;
+    int channels;
+    // per channel state as arrays indexed by channel
+    LADSPA_Data* in[PLUGIN_MAX_CHANNELS];
+    LADSPA_Data* out[PLUGIN_MAX_CHANNELS];
+    double weight[PLUGIN_MAX_CHANNELS];
+    // sum of the weights, the loudness is the weighted mean power of the channels
+    double weightSum;
+    // 0 if runs are processed per frame, when the chunk kernels are disabled by LEVELER_SIMD=scalar or DEBUG
+    int chunked;
+    unsigned long rate;
+    double input_gain;
+    LADSPA_Data* input_gain_port;
+    LADSPA_Data* latency_port;
+    struct Window window;
+    struct Meter* meter;
+};
+
+static void destroyLeveler(Surround *h) {
+    if (h == NULL) return;
+    freeWindow(&h->window);
+    closeMeter(h->meter);
+    free(h);
+}
+
+static RunFunction selectRun(const struct PluginConfig* config);
+
+LADSPA_Handle surround_leveler_instantiate(const LADSPA_Descriptor * d, unsigned long rate) {
+    const struct PluginConfig* config = (const struct PluginConfig*) d->ImplementationData;
+    if (config->channels < 1 || config->channels > PLUGIN_MAX_CHANNELS
+            || d->PortCount != (unsigned long) (2 * config->channels + 2)) return NULL;
+    Surround * h = calloc(1, sizeof(Surround));
+    if (h == NULL) return NULL;
+    h->config = config;
+    h->process = selectRun(config);
+    h->chunked = getChunkKernel(config->lookAhead) != NULL;
+    h->channels = config->channels;
+    h->rate = rate;
+    h->input_gain = 1.0;
+    for (int c = 0; c < h->channels; c++) {
+        h->weight[c] = config->channelWeight[c];
+        h->weightSum += h->weight[c];
+    }
+    if (h->weightSum <= 0.0) {
+        destroyLeveler(h);
+        return NULL;
+    }
+    h->meter = openMeter(d->Label, rate);
+
+    if (!initWindowChannels(&h->window, h->channels, config->lookAhead, config->bufferDuration[0], h->rate, MAX_CHANGE, ADJUST_RATE)
+            || (config->lookAheadDelay > 0 && !setWindowDelay(&h->window, config->lookAheadDelay, h->rate))) {
+        destroyLeveler(h);
+        return NULL;
+    }
+    return (LADSPA_Handle) h;
+}
+
+void surround_leveler_cleanup(LADSPA_Handle handle) {
+    Surround * h = (Surround *) handle;
+    destroyLeveler(h);
+}
+
+void surround_leveler_connect_port(const LADSPA_Handle handle, unsigned long num, LADSPA_Data *port) {
+    Surround * h = (Surround *) handle;
+    unsigned long channels = (unsigned long) h->channels;
+    if (num < channels) h->in[num] = port;
+    else if (num < 2 * channels) h->out[num - channels] = port;
+    else if (num == 2 * channels) h->input_gain_port = port;
+    else if (num == 2 * channels + 1) h->latency_port = port;
+}
+
+// process n samples of all channels from sample s, returns 0 if the chunk has to be processed by the per frame path,
+// output is bit-identical to it, the sums differ by rounding only as with the block kernels
+static inline __attribute__((always_inline))
+unsigned long runSurroundChunk(Surround* h, unsigned long s, unsigned long n, const int channels, const int lookAhead) {
+    struct Window* window = &h->window;
+    LADSPA_Data* data = NULL;
+    const LADSPA_Data* delayed = NULL;
+    if (lookAhead) {
+        unsigned long playPosition = window->index + window->ringSize - window->delay;
+        if (playPosition >= window->ringSize)
+            playPosition -= window->ringSize;
+        data = window->data + channels * window->index;
+        delayed = window->data + channels * playPosition;
+        // output is read from the ring, which is only exact if the dc offset stays zero for the whole chunk
+        const double size = window->powerSize + 1;
+        for (int c = 0; c < channels; c++) {
+            double diff = fabs(window->sum[c]);
+            for (unsigned long j = 0; j < n; j++)
+                diff += fabs((double) (h->in[c][s + j] * h->input_gain));
+            if (diff >= dcOffsetLimit * size) return 0;
+        }
+    }
+
+    // amplification of the chunk, shared by all channels
+    const double* ramp = window->ramp + window->adjustPosition;
+    const double oldAmp = window->oldAmplification;
+    const double delta = window->amplification - oldAmp;
+    double ampFactor[KERNEL_CHUNK];
+    for (unsigned long j = 0; j < n; j++)
+        ampFactor[j] = oldAmp + ramp[j] * delta;
+
+    double power = 0.0;
+    for (int c = 0; c < channels; c++) {
+        const LADSPA_Data* in = h->in[c] + s;
+        LADSPA_Data* out = h->out[c] + s;
+        double sum = 0.0;
+        double square = 0.0;
+        for (unsigned long j = 0; j < n; j++) {
+            LADSPA_Data x = in[j] * h->input_gain;
+            double value = x;
+            if (lookAhead) {
+                value = delayed[channels * j + c];
+                data[channels * j + c] = x;
+                sum += x;
+            }
+            square += (double) x * x;
+            value *= ampFactor[j];
+            // limit() does not change values up to compressionStart
+            out[j] = (LADSPA_Data) ((fabs(value) > compressionStart) ? limit(value) : value);
+        }
+        window->sum[c] += sum;
+        window->blockSum[c] += sum;
+        power += h->weight[c] * square;
+    }
+    window->sumSquare += power;
+    window->blockPower += power;
+    advanceWindow(window, n);
+    return n;
+}
+
+// process all channels of a frame in one pass, channels is a constant of the stamped run functions,
+// so the channel loops are unrolled and the frame stays in registers
+static inline __attribute__((always_inline))
+void runSurround(Surround* h, unsigned long samples, const int channels, const int isLeveler, const int lookAhead) {
+    struct Window* window = &h->window;
+    for (int c = 0; c < channels; c++)
+        if (h->in[c] == NULL || h->out[c] == NULL) return;
+
+    for (unsigned long s = 0; s < samples;) {
+        unsigned long n = h->chunked ? getChunkSize(window, samples - s) : 0;
+        if (n > 0 && runSurroundChunk(h, s, n, channels, lookAhead) == n) {
+            s += n;
+            continue;
+        }
+        unsigned long end = s + ((n > 0) ? n : 1);
+        for (; s < end; s++) {
+            LADSPA_Data frame[PLUGIN_MAX_CHANNELS];
+            double power = 0.0;
+            for (int c = 0; c < channels; c++) {
+                frame[c] = h->in[c][s] * h->input_gain;
+                power += h->weight[c] * ((double) frame[c] * frame[c]);
+            }
+            prepareWindow(window);
+            addWindowChannels(window, frame, channels);
+            sumWindowPower(window, power);
+            double ampFactor = interpolateAmplification(window, window->amplification, window->oldAmplification);
+            if (lookAhead) {
+                const LADSPA_Data* played = &window->data[channels * window->playPosition];
+                for (int c = 0; c < channels; c++)
+                    h->out[c][s] = (LADSPA_Data) limit(ampFactor * (played[c] - getWindowChannelDcOffset(window, c)));
+            } else {
+                for (int c = 0; c < channels; c++)
+                    h->out[c][s] = (LADSPA_Data) limit(ampFactor * frame[c]);
+            }
+#ifdef DEBUG
+            printWindow(window, 1);
+#endif
+            if (window->adjustPosition == 0)
+                calcWindowAmplification(window, getRmsValue(window->sumSquare, window->powerSize * h->weightSum),
+                    isLeveler, h->input_gain);
+            moveWindow(window);
+        }
+    }
+}
+
+// stamp out a run function for each mode and look ahead, for 5.1, 7.1 and any other number of channels
+#define DEFINE_RUN(name, isLeveler, lookAhead) \
+    static void name##6(Surround* h, unsigned long samples) { \
+        runSurround(h, samples, 6, isLeveler, lookAhead); \
+    } \
+    static void name##8(Surround* h, unsigned long samples) { \
+        runSurround(h, samples, 8, isLeveler, lookAhead); \
+    } \
+    static void name(Surround* h, unsigned long samples) { \
+        runSurround(h, samples, h->channels, isLeveler, lookAhead); \
+    }
+
+DEFINE_RUN(runLevelerLookAhead, 1, 1)
+DEFINE_RUN(runLevelerInstant,   1, 0)
+DEFINE_RUN(runLimiterLookAhead, 0, 1)
+DEFINE_RUN(runLimiterInstant,   0, 0)
+
+static RunFunction selectRun(const struct PluginConfig* config) {
+    static const RunFunction runs[2][2][3] = {
+        { { runLimiterInstant,   runLimiterInstant6,   runLimiterInstant8   },
+          { runLimiterLookAhead, runLimiterLookAhead6, runLimiterLookAhead8 } },
+        { { runLevelerInstant,   runLevelerInstant6,   runLevelerInstant8   },
+          { runLevelerLookAhead, runLevelerLookAhead6, runLevelerLookAhead8 } },
+    };
+    int layout = (config->channels == 6) ? 1 : (config->channels == 8) ? 2 : 0;
+    return runs[config->isLeveler != 0][config->lookAhead != 0][layout];
+}
+
+void surround_leveler_run(LADSPA_Handle handle, unsigned long samples) {
+    Surround * h = (Surround *) handle;
+    if (h == NULL || h->input_gain_port == NULL || samples == 0) return;
+    h->input_gain = pow(10.0, *(h->input_gain_port) / 20.0);
+    if (h->latency_port != NULL) *(h->latency_port) = (LADSPA_Data) h->window.delay;
+    h->process(h, samples);
+    // the meter shows the front left and right outputs with the linked loudness, see meter.h
+    if (h->meter != NULL && addMeterBlock(h->meter, h->out[0], h->out[h->channels > 1 ? 1 : 0], samples))
+        publishMeter(h->meter, h->window.loudness, h->window.loudness, h->window.amplification, h->window.amplification);
+}
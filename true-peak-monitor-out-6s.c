@@ -0,0 +1,22 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "plugins.h"
+
+static const struct PluginConfig config = {
+    // long term measurement window
+    .bufferDuration = {6.0},
+    .logId = "peak-out",
+    // 4 times oversampled true peak, reported alongside the sample peak
+    .truePeakLogId = "true-peak-out",
+};
+
+const LADSPA_Descriptor true_peak_monitor_out_6s_descriptor = { .UniqueID = 0x22b418,
+    .Label = "true_peak_monitor_out_6s", .Name = "true peak monitor out, 6 seconds window",
+    .Maker = "Milan Chrobok", .Copyright = "GPL 3",
+    .PortCount = 4, .connect_port = peak_monitor_connect_port,
+    .PortNames = c_port_names, .PortRangeHints = psPortRangeHints,
+    .PortDescriptors = c_port_descriptors,
+    .ImplementationData = (void*) &config,
+    .instantiate = peak_monitor_instantiate, .run = peak_monitor_run, .cleanup = peak_monitor_cleanup
+};
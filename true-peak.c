@@ -0,0 +1,91 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <string.h>
+#include "true-peak.h"
+
+typedef int32_t TruePeakMask __attribute__((vector_size(16)));
+
+// interpolation filter of ITU-R BS.1770-4 Annex 2, coefficients of the 4 phases per tap
+static const TruePeakPhases coefficients[TRUE_PEAK_TAPS] = {
+    { 0.0017089843750f, -0.0291748046875f, -0.0189208984375f, -0.0083007812500f},
+    { 0.0109863281250f,  0.0292968750000f,  0.0330810546875f,  0.0148925781250f},
+    {-0.0196533203125f, -0.0517578125000f, -0.0582275390625f, -0.0266113281250f},
+    { 0.0332031250000f,  0.0891113281250f,  0.1015625000000f,  0.0476074218750f},
+    {-0.0594482421875f, -0.1665039062500f, -0.2003173828125f, -0.1022949218750f},
+    { 0.1373291015625f,  0.4650878906250f,  0.7797851562500f,  0.9721679687500f},
+    { 0.9721679687500f,  0.7797851562500f,  0.4650878906250f,  0.1373291015625f},
+    {-0.1022949218750f, -0.2003173828125f, -0.1665039062500f, -0.0594482421875f},
+    { 0.0476074218750f,  0.1015625000000f,  0.0891113281250f,  0.0332031250000f},
+    {-0.0266113281250f, -0.0582275390625f, -0.0517578125000f, -0.0196533203125f},
+    { 0.0148925781250f,  0.0330810546875f,  0.0292968750000f,  0.0109863281250f},
+    {-0.0083007812500f, -0.0189208984375f, -0.0291748046875f,  0.0017089843750f},
+};
+
+void initTruePeak(struct TruePeak* truePeak) {
+    memset(truePeak, 0, sizeof(*truePeak));
+}
+
+static inline TruePeakPhases maxPhases(TruePeakPhases a, TruePeakPhases b) {
+    TruePeakMask greater = a > b;
+    return (TruePeakPhases) (((TruePeakMask) a & greater) | ((TruePeakMask) b & ~greater));
+}
+
+static inline TruePeakPhases absPhases(TruePeakPhases value) {
+    return (TruePeakPhases) ((TruePeakMask) value & 0x7fffffff);
+}
+
+// absolute values of the 4 phases of a frame, position is the history slot of the frame
+static inline TruePeakPhases filterFrame(struct TruePeakChannel* channel, int position, LADSPA_Data sample) {
+    TruePeakPhases value = {sample, sample, sample, sample};
+    channel->history[position] = value;
+    channel->history[position + TRUE_PEAK_TAPS] = value;
+    // the newest sample is at position + TRUE_PEAK_TAPS, the oldest at position + 1
+    const TruePeakPhases* taps = &channel->history[position + TRUE_PEAK_TAPS];
+    // two sums halve the dependency chain of the additions
+    TruePeakPhases even = coefficients[0] * taps[0];
+    TruePeakPhases odd = coefficients[1] * taps[-1];
+#pragma GCC unroll 6
+    for (int k = 2; k < TRUE_PEAK_TAPS; k += 2) {
+        even += coefficients[k] * taps[-k];
+        odd += coefficients[k + 1] * taps[-k - 1];
+    }
+    return absPhases(even + odd);
+}
+
+// oversample one channel, position is the history slot of the first frame
+static void addChannel(struct TruePeakChannel* channel, int position, const LADSPA_Data* in, unsigned long samples) {
+    TruePeakPhases peak = channel->peak;
+    for (unsigned long s = 0; s < samples; s++) {
+        peak = maxPhases(peak, filterFrame(channel, position, in[s]));
+        if (++position == TRUE_PEAK_TAPS) position = 0;
+    }
+    channel->peak = peak;
+}
+
+void addTruePeak(struct TruePeak* truePeak, const LADSPA_Data* left, const LADSPA_Data* right, unsigned long samples) {
+    const LADSPA_Data* inputs[] = {left, right};
+    for (int c = 0; c < 2; c++) {
+        if (inputs[c] != NULL) addChannel(&truePeak->channel[c], truePeak->position, inputs[c], samples);
+    }
+    truePeak->position = (int) ((truePeak->position + samples) % TRUE_PEAK_TAPS);
+}
+
+double filterTruePeak(struct TruePeakChannel* channel, int position, LADSPA_Data sample) {
+    TruePeakPhases phases = filterFrame(channel, position, sample);
+    float low = (phases[0] > phases[1]) ? phases[0] : phases[1];
+    float high = (phases[2] > phases[3]) ? phases[2] : phases[3];
+    return (low > high) ? low : high;
+}
+
+void readTruePeak(struct TruePeak* truePeak, double* left, double* right) {
+    double* peaks[] = {left, right};
+    for (int c = 0; c < 2; c++) {
+        TruePeakPhases peak = truePeak->channel[c].peak;
+        double max = 0.0;
+        for (int p = 0; p < 4; p++)
+            if (peak[p] > max) max = peak[p];
+        *peaks[c] = max;
+        truePeak->channel[c].peak = (TruePeakPhases) {0.0f, 0.0f, 0.0f, 0.0f};
+    }
+}
@@ -0,0 +1,44 @@
+//  SPDX-FileCopyrightText: 2026 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef true_peak_h
+#define true_peak_h
+
+// True peak of a pair of channels as in ITU-R BS.1770 Annex 2.
+//
+// The input is oversampled 4 times by the 48 tap polyphase FIR of the standard,
+// 12 taps per phase. The four phases of a frame are computed together in the
+// lanes of one vector per channel, each input sample is kept broadcast to all
+// lanes, so a frame costs 12 vector multiply-adds per channel and the running
+// maximum is only reduced to a scalar when it is read.
+
+#include <stdint.h>
+#include <ladspa.h>
+
+#define TRUE_PEAK_TAPS 12
+
+// the 4 phases of an oversampled frame
+typedef float TruePeakPhases __attribute__((vector_size(16)));
+
+struct TruePeakChannel {
+    // the last input samples broadcast to all lanes, written twice so the taps are read without wrap
+    TruePeakPhases history[2 * TRUE_PEAK_TAPS];
+    // largest absolute value per phase since the last read
+    TruePeakPhases peak;
+};
+
+struct TruePeak {
+    struct TruePeakChannel channel[2];
+    int position;
+};
+
+void initTruePeak(struct TruePeak* truePeak);
+// oversample a block of both channels, NULL channels are skipped
+void addTruePeak(struct TruePeak* truePeak, const LADSPA_Data* left, const LADSPA_Data* right, unsigned long samples);
+// absolute true peak of each channel since the last read, resets the peaks but keeps the filter history
+void readTruePeak(struct TruePeak* truePeak, double* left, double* right);
+// add one sample to the history of a channel at a slot from 0 to TRUE_PEAK_TAPS - 1 that advances by one per sample,
+// returns the largest absolute value of the 4 phases, which lie TRUE_PEAK_TAPS / 2 samples back
+double filterTruePeak(struct TruePeakChannel* channel, int position, LADSPA_Data sample);
+
+#endif
@@ -0,0 +1,254 @@
+//  SPDX-FileCopyrightText: 2016 Milan Chrobok
+//  SPDX-License-Identifier: GPL-3.0-or-later
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <pthread.h>
+#include <ladspa.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include "window.h"
+#include "amplify.h"
+
+// the ramp of an adjust period, shared by all windows of the process with the same period
+struct WindowRamp {
+    unsigned long size;
+    int users;
+    struct WindowRamp* next;
+    double shape[];
+};
+
+static struct WindowRamp* ramps = NULL;
+static pthread_mutex_t rampMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static const double* acquireRamp(unsigned long size) {
+    if (size == 0) size = 1;
+    pthread_mutex_lock(&rampMutex);
+    struct WindowRamp* ramp = ramps;
+    while (ramp != NULL && ramp->size != size) ramp = ramp->next;
+    if (ramp == NULL) {
+        ramp = (struct WindowRamp*) malloc(sizeof(struct WindowRamp) + size * sizeof(double));
+        if (ramp != NULL) {
+            ramp->size = size;
+            ramp->users = 0;
+            for (unsigned long i = 0; i < size; i++) {
+                double x = (double) i / size;
+                ramp->shape[i] = x * x * (3 - 2 * x);
+            }
+            ramp->next = ramps;
+            ramps = ramp;
+        }
+    }
+    if (ramp != NULL) ramp->users++;
+    pthread_mutex_unlock(&rampMutex);
+    return (ramp == NULL) ? NULL : ramp->shape;
+}
+
+static void releaseRamp(const double* shape) {
+    pthread_mutex_lock(&rampMutex);
+    for (struct WindowRamp** ramp = &ramps; *ramp != NULL; ramp = &(*ramp)->next) {
+        if ((*ramp)->shape != shape) continue;
+        struct WindowRamp* unused = *ramp;
+        if (--unused->users == 0) {
+            *ramp = unused->next;
+            free(unused);
+        }
+        break;
+    }
+    pthread_mutex_unlock(&rampMutex);
+}
+
+// map the pages of a ring twice back to back, returns NULL if not supported
+static LADSPA_Data* mapMirroredRing(size_t bytes) {
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+    int fd = memfd_create("rms-leveler-ring", MFD_CLOEXEC);
+    if (fd < 0) return NULL;
+    if (ftruncate(fd, bytes) != 0) {
+        close(fd);
+        return NULL;
+    }
+    // reserve both halves first, so the mirror is guaranteed to follow the ring
+    char* ring = mmap(NULL, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring != MAP_FAILED
+            && (mmap(ring, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED
+            || mmap(ring + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)) {
+        munmap(ring, 2 * bytes);
+        ring = MAP_FAILED;
+    }
+    close(fd);
+    return (ring == MAP_FAILED) ? NULL : (LADSPA_Data*) ring;
+#else
+    return NULL;
+#endif
+}
+
+static void freeWindowRing(struct Window* window) {
+    if (window->data == NULL) return;
+#ifdef __linux__
+    if (window->mirrored)
+        munmap(window->data, 2 * window->ringSize * window->channels * sizeof(LADSPA_Data));
+    else
+#endif
+        free(window->data);
+    window->data = NULL;
+    window->mirrored = 0;
+}
+
+void freeWindow(struct Window* window) {
+    if (window == NULL) return;
+    if (window->ramp != NULL) {
+        releaseRamp(window->ramp);
+        window->ramp = NULL;
+    }
+    freeWindowRing(window);
+    if (window->power != NULL) {
+        free(window->power);
+        window->power = NULL;
+    }
+    if (window->offset != NULL) {
+        free(window->offset);
+        window->offset = NULL;
+    }
+}
+
+static int allocWindowRing(struct Window* window, unsigned long delay) {
+    freeWindowRing(window);
+    // a mirrored ring is rounded up to whole pages and whole frames
+    const size_t frameBytes = window->channels * sizeof(LADSPA_Data);
+    unsigned long ringSize = delay + 1;
+#ifdef __linux__
+    const size_t page = sysconf(_SC_PAGESIZE);
+    size_t bytes = (ringSize * frameBytes + page - 1) / page * page;
+    while (bytes % frameBytes != 0) bytes += page;
+    window->data = mapMirroredRing(bytes);
+    if (window->data != NULL) {
+        window->mirrored = 1;
+        ringSize = bytes / frameBytes;
+    }
+#endif
+    if (window->data == NULL) {
+        window->data = (LADSPA_Data*) calloc(ringSize, frameBytes);
+        if (window->data == NULL) return 0;
+    }
+    window->delay = delay;
+    window->ringSize = ringSize;
+    window->index = 0;
+    window->playPosition = 0;
+    return 1;
+}
+
+int initWindowChannels(struct Window* window, int channels, int look_ahead, double duration, double rate, double max_change, double adjust_rate) {
+    if (window == NULL || channels < 1 || channels > WINDOW_MAX_CHANNELS) return 0;
+    freeWindow(window);
+    window->look_ahead = look_ahead;
+    window->channels = channels;
+    window->data = NULL;
+    window->power = NULL;
+    window->offset = NULL;
+    window->ramp = NULL;
+    window->mirrored = 0;
+    window->delay = 0;
+    window->ringSize = 1;
+    if (duration > 0) {
+        window->active = 1;
+        window->duration = duration;
+        window->dataSize = (unsigned long) (duration * rate);
+        window->blocks = window->dataSize / WINDOW_BLOCK;
+        if (window->blocks == 0) window->blocks = 1;
+        window->power = (double*) calloc(window->blocks, sizeof(double));
+        if (window->power == NULL) {
+            freeWindow(window);
+            return 0;
+        }
+        // by default play back from the middle of the window
+        if (look_ahead) {
+            window->offset = (double*) calloc(window->blocks * channels, sizeof(double));
+            if (window->offset == NULL || !allocWindowRing(window, window->dataSize - window->dataSize / 2)) {
+                freeWindow(window);
+                return 0;
+            }
+        }
+    }
+    for (int c = 0; c < WINDOW_MAX_CHANNELS; c++) {
+        window->sum[c] = 0;
+        window->blockSum[c] = 0;
+    }
+    window->sumSquare = 0;
+    window->powerSize = 0;
+    window->block = 0;
+    window->blockPosition = 0;
+    window->blockPower = 0.0;
+    window->ranges = 0;
+    window->loudness = 0.0;
+    window->oldLoudness = 0.0;
+    window->position = 0.0;
+    window->index = 0;
+    window->adjustPosition = 0;
+    window->adjustRate = (int) ( rate * adjust_rate ) ;
+    if (window->active) {
+        window->ramp = acquireRamp((unsigned long) window->adjustRate);
+        if (window->ramp == NULL) {
+            freeWindow(window);
+            return 0;
+        }
+    }
+    window->target = TARGET_LOUDNESS;
+    window->maxAmpChange = max_change * adjust_rate;
+    window->deltaPosition = 1.0 / rate;
+    window->amplification = 1.0;
+    window->oldAmplification = 1.0;
+    return 1;
+}
+
+int initWindow(struct Window* window, int look_ahead, double duration, double rate, double max_change, double adjust_rate) {
+    return initWindowChannels(window, 1, look_ahead, duration, rate, max_change, adjust_rate);
+}
+
+// measure the most recent duration seconds of the power history, returns the range index or -1
+int addWindowRange(struct Window* window, double duration, double rate) {
+    if (window == NULL || !window->active || window->ranges >= WINDOW_MAX_RANGES) return -1;
+    unsigned long blocks = (unsigned long) (duration * rate) / WINDOW_BLOCK;
+    if (blocks == 0) blocks = 1;
+    if (blocks > window->blocks) blocks = window->blocks;
+    struct WindowRange* range = &window->range[window->ranges];
+    range->blocks = blocks;
+    range->skip = 0;
+    range->sumSquare = 0.0;
+    range->frames = 0;
+    return window->ranges++;
+}
+
+// change the duration of a range while running, centered on the played frame as far as the delay allows,
+// its sum is taken from the power history, so the measurement does not start over,
+// costs one pass over the history and allocates nothing
+void setWindowRange(struct Window* window, int r, double duration, double rate) {
+    if (window == NULL || r < 0 || r >= window->ranges) return;
+    unsigned long frames = (unsigned long) (duration * rate);
+    unsigned long blocks = frames / WINDOW_BLOCK;
+    if (blocks == 0) blocks = 1;
+    if (blocks > window->blocks) blocks = window->blocks;
+    unsigned long skip = (window->delay > frames / 2) ? (window->delay - frames / 2) / WINDOW_BLOCK : 0;
+    if (skip > window->blocks - blocks) skip = window->blocks - blocks;
+    struct WindowRange* range = &window->range[r];
+    if (blocks == range->blocks && skip == range->skip) return;
+    range->blocks = blocks;
+    range->skip = skip;
+    range->sumSquare = 0.0;
+    // the completed blocks precede the current one, older slots are still 0 while the history fills
+    for (unsigned long b = skip + 1; b <= skip + blocks; b++) {
+        unsigned long i = window->block + window->blocks - b;
+        if (i >= window->blocks) i -= window->blocks;
+        range->sumSquare += window->power[i];
+    }
+    unsigned long completed = (window->powerSize - window->blockPosition) / WINDOW_BLOCK;
+    completed = (completed > skip) ? completed - skip : 0;
+    range->frames = ((completed < blocks) ? completed : blocks) * WINDOW_BLOCK;
+}
+
+// set the look ahead delay of a window, independent of its length
+int setWindowDelay(struct Window* window, double delay, double rate) {
+    if (window == NULL || !window->active || !window->look_ahead || delay < 0) return 0;
+    return allocWindowRing(window, (unsigned long) (delay * rate));
+}
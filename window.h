@@ -4,19 +4,64 @@
 #ifndef window_h
 #define window_h
 
+#include <stdlib.h>
+#include <ladspa.h>
+
 // amplitude limit to what DC offset is not removed
-const double dcOffsetLimit = 0.005;
+static const double dcOffsetLimit = 0.005;
+// maximum number of interleaved channels per window, 8 for 7.1
+#define WINDOW_MAX_CHANNELS 8
+// number of frames per entry of the power history
+#define WINDOW_BLOCK 64
+// maximum number of ranges measured from one power history
+#define WINDOW_MAX_RANGES 4
+
+// the most recent blocks of the power history of a window,
+// for measuring several window lengths from one history
+struct WindowRange {
+    unsigned long blocks;
+    // newest completed blocks left out, to center a range shorter than twice the delay on the played frame
+    unsigned long skip;
+    // sum of squares of the completed blocks in the range over frames
+    double sumSquare;
+    unsigned long frames;
+};
 
+// The power and the DC sums of the window are kept per block of WINDOW_BLOCK frames,
+// so they cover dataSize rounded down to whole blocks plus the current partial block.
+// The frames themselves are only stored for look ahead, in a ring of at least delay + 1 frames,
+// independent of the window length. Where possible the pages of the ring are mapped twice
+// back to back, so a span of up to ringSize frames from any position is contiguous.
 struct Window {
     int active;
     int look_ahead;
+    int channels;
     double duration;
-    unsigned long size;
+    // window length in frames
     unsigned long dataSize;
+    // look ahead delay in frames
+    unsigned long delay;
+    unsigned long ringSize;
+    // 1 if the ring is followed by a mirror of itself, 0 if spans have to be split at the wrap
+    int mirrored;
+    // interleaved frames of all channels, NULL without look ahead
     LADSPA_Data* data;
-    double* square;
+    // sum of samples per completed block and channel, NULL without look ahead
+    double* offset;
+    double blockSum[WINDOW_MAX_CHANNELS];
+    // sum of squares of all channels per completed block
+    double* power;
+    unsigned long blocks;
+    unsigned long block;
+    // frames and sum of squares of the current block
+    unsigned long blockPosition;
+    double blockPower;
+    // sum of squares of the completed blocks and the current block over powerSize frames
     double sumSquare;
-    double sum;
+    unsigned long powerSize;
+    int ranges;
+    struct WindowRange range[WINDOW_MAX_RANGES];
+    double sum[WINDOW_MAX_CHANNELS];
     double loudness;
     double oldLoudness;
     double position;
@@ -25,113 +70,189 @@ struct Window {
     unsigned long adjustPosition;
     unsigned long playPosition;
     double adjustRate;
+    // shared smoothstep from 0 to 1 over one adjust period, indexed by adjustPosition, NULL if not active
+    const double* ramp;
+    // target loudness in dB and maximum amplification change per adjust period, may be changed between runs
+    double target;
     double maxAmpChange;
     double amplification;
     double oldAmplification;
 };
 
-void freeWindow(struct Window* window) {
-    if (window == NULL) return;
-    if (window->data != NULL) {
-        free(window->data);
-        window->data = NULL;
-    }
-    if (window->square != NULL) {
-        free(window->square);
-        window->square = NULL;
-    }
+void freeWindow(struct Window* window);
+
+int initWindowChannels(struct Window* window, int channels, int look_ahead, double duration, double rate, double max_change, double adjust_rate);
+
+int initWindow(struct Window* window, int look_ahead, double duration, double rate, double max_change, double adjust_rate);
+
+int setWindowDelay(struct Window* window, double delay, double rate);
+
+int addWindowRange(struct Window* window, double duration, double rate);
+
+void setWindowRange(struct Window* window, int r, double duration, double rate);
+
+static inline void addWindowData(struct Window* window, LADSPA_Data value) {
+    if (window->data == NULL) return;
+    window->data[window->index] = value;
+    window->blockSum[0] += value;
+    window->sum[0] += value;
 }
 
-int initWindow(struct Window* window, int look_ahead, double duration, double rate, double max_change, double adjust_rate) {
-    if (window == NULL) return 0;
-    freeWindow(window);
-    window->look_ahead = look_ahead;
-    window->data = NULL;
-    window->square = NULL;
-    if (duration > 0) {
-        window->active = 1;
-        window->duration = duration;
-        window->dataSize = (unsigned long) (duration * rate);
-        window->data = (LADSPA_Data*) calloc(window->dataSize, sizeof(LADSPA_Data));
-        if (window->data == NULL) {
-            freeWindow(window);
-            return 0;
-        }
-        window->square = (double*) calloc(window->dataSize, sizeof(double));
-        if (window->square == NULL) {
-            freeWindow(window);
-            return 0;
-        }
-    }
-    window->sum = 0;
-    window->sumSquare = 0;
-    window->loudness = 0.0;
-    window->oldLoudness = 0.0;
-    window->size = 0;
-    window->position = 0.0;
-    window->index = 0;
-    window->adjustPosition = 0;
-    window->adjustRate = (int) ( rate * adjust_rate ) ;
-    window->maxAmpChange = max_change * adjust_rate;
-    window->deltaPosition = 1.0 / rate;
-    window->amplification = 1.0;
-    window->oldAmplification = 1.0;
-    return 1;
+// add a frame of a stereo window
+static inline void addWindowFrame(struct Window* window, LADSPA_Data left, LADSPA_Data right) {
+    if (window->data == NULL) return;
+    LADSPA_Data* frame = &window->data[2 * window->index];
+    frame[0] = left;
+    frame[1] = right;
+    window->blockSum[0] += left;
+    window->blockSum[1] += right;
+    window->sum[0] += left;
+    window->sum[1] += right;
 }
 
-inline void addWindowData(struct Window* window, LADSPA_Data value) {
-    if (!window->active) return;
-    window->sum -= window->data[window->index];
-    window->data[window->index] = value;
-    window->sum += window->data[window->index];
+// add a frame of all channels of a window, channels is a constant of the caller so the loops can be unrolled
+static inline __attribute__((always_inline))
+void addWindowChannels(struct Window* window, const LADSPA_Data* values, const int channels) {
+    if (window->data == NULL) return;
+    LADSPA_Data* frame = &window->data[channels * window->index];
+    for (int c = 0; c < channels; c++) {
+        frame[c] = values[c];
+        window->blockSum[c] += values[c];
+        window->sum[c] += values[c];
+    }
 }
 
-inline void sumWindowData(struct Window* window) {
+// sum the power of a frame, e.g. of a weighted signal
+static inline void sumWindowPower(struct Window* window, double square) {
     if (!window->active) return;
-    double value = window->data[window->index];
-    window->sumSquare -= window->square[window->index];
-    window->square[window->index] = value * value;
-    window->sumSquare += window->square[window->index];
+    window->blockPower += square;
+    window->blockPosition++;
+    window->sumSquare += square;
+    window->powerSize++;
 }
 
-inline void prepareWindow(struct Window* window) {
-    if (!window->active) return;
-    //increase buffer size on start
-    if (window->size < window->dataSize)
-        window->size++;
+static inline void sumWindowData(struct Window* window, LADSPA_Data value) {
+    sumWindowPower(window, (double) value * value);
+}
 
-    window->playPosition = window->index + window->dataSize / 2;
-    if (window->playPosition >= window->dataSize)
-        window->playPosition -= window->dataSize;
+// sum the power of both channels of a stereo window
+static inline void sumWindowFrame(struct Window* window, LADSPA_Data left, LADSPA_Data right) {
+    sumWindowPower(window, (double) left * left + (double) right * right);
+}
 
-    while (window->index >= window->dataSize) {
-        window->index -= window->dataSize;
+// store the completed block in place of the oldest one
+static inline void nextWindowBlock(struct Window* window) {
+    for (int r = 0; r < window->ranges; r++) {
+        struct WindowRange* range = &window->range[r];
+        unsigned long oldest = window->block + window->blocks - range->skip - range->blocks;
+        if (oldest >= window->blocks) oldest -= window->blocks;
+        double newest = window->blockPower;
+        if (range->skip > 0) {
+            unsigned long skipped = window->block + window->blocks - range->skip;
+            if (skipped >= window->blocks) skipped -= window->blocks;
+            newest = window->power[skipped];
+        }
+        range->sumSquare += newest - window->power[oldest];
+        // the range only grows once the skipped blocks have completed, as in setWindowRange()
+        if (window->powerSize > range->skip * WINDOW_BLOCK && range->frames < range->blocks * WINDOW_BLOCK)
+            range->frames += WINDOW_BLOCK;
+    }
+    window->sumSquare -= window->power[window->block];
+    window->power[window->block] = window->blockPower;
+    window->blockPower = 0.0;
+    window->blockPosition = 0;
+    if (window->offset != NULL) {
+        double* offset = &window->offset[window->block * window->channels];
+        for (int c = 0; c < window->channels; c++) {
+            window->sum[c] -= offset[c];
+            offset[c] = window->blockSum[c];
+            window->blockSum[c] = 0.0;
+        }
+    }
+    if (window->powerSize > window->blocks * WINDOW_BLOCK)
+        window->powerSize -= WINDOW_BLOCK;
+    window->block++;
+    if (window->block < window->blocks) return;
+    // sum up again once per cycle, so rounding errors do not accumulate
+    window->block = 0;
+    window->sumSquare = 0.0;
+    for (unsigned long b = 0; b < window->blocks; b++)
+        window->sumSquare += window->power[b];
+    for (int r = 0; r < window->ranges; r++) {
+        struct WindowRange* range = &window->range[r];
+        range->sumSquare = 0.0;
+        for (unsigned long b = window->blocks - range->skip - range->blocks; b < window->blocks - range->skip; b++)
+            range->sumSquare += window->power[b];
+    }
+    if (window->offset == NULL) return;
+    for (int c = 0; c < window->channels; c++) {
+        window->sum[c] = 0.0;
+        for (unsigned long b = 0; b < window->blocks; b++)
+            window->sum[c] += window->offset[b * window->channels + c];
     }
 }
 
-inline void moveWindow(struct Window* window) {
+static inline void prepareWindow(struct Window* window) {
     if (!window->active) return;
+    // play the frame which was added delay frames ago
+    window->playPosition = window->index + window->ringSize - window->delay;
+    if (window->playPosition >= window->ringSize)
+        window->playPosition -= window->ringSize;
+}
 
-    window->index += 1;
-    if (window->index >= window->dataSize)
-        window->index -= window->dataSize;
+static inline void moveWindow(struct Window* window) {
+    if (!window->active) return;
 
-    window->playPosition += 1;
-    if (window->playPosition >= window->dataSize)
-        window->playPosition -= window->dataSize;
+    window->index += 1;
+    if (window->index >= window->ringSize)
+        window->index -= window->ringSize;
 
     window->adjustPosition += 1;
     if (window->adjustPosition >= window->adjustRate)
         window->adjustPosition -= window->adjustRate;
 
+    if (window->blockPosition >= WINDOW_BLOCK)
+        nextWindowBlock(window);
+
     window->position += window->deltaPosition;
 }
 
-inline double getWindowDcOffset(struct Window* window) {
-    double dcOffset = window->sum / window->size;
+// move by n samples at once, n must not pass an adjust point, a block or the wrap of a ring that is not mirrored,
+// the samples and their power have to be added to the block sums by the caller
+static inline void advanceWindow(struct Window* window, unsigned long n) {
+    window->powerSize += n;
+    window->blockPosition += n;
+
+    window->index += n;
+    if (window->index >= window->ringSize)
+        window->index -= window->ringSize;
+
+    window->adjustPosition += n;
+    if (window->adjustPosition >= window->adjustRate)
+        window->adjustPosition -= window->adjustRate;
+
+    if (window->blockPosition >= WINDOW_BLOCK)
+        nextWindowBlock(window);
+
+    window->position += n * window->deltaPosition;
+}
+
+static inline double getWindowChannelDcOffset(struct Window* window, int channel) {
+    double dcOffset = window->sum[channel] / window->powerSize;
     if ((dcOffset > -dcOffsetLimit) && (dcOffset < dcOffsetLimit))
         return 0.0;
     return dcOffset;
 }
 
+static inline double getWindowDcOffset(struct Window* window) {
+    return getWindowChannelDcOffset(window, 0);
+}
+
+// sample of a channel the given number of frames after the played one, at most delay, without DC offset
+static inline double getWindowAhead(struct Window* window, unsigned long frames, int channel) {
+    unsigned long position = window->playPosition + frames;
+    if (position >= window->ringSize) position -= window->ringSize;
+    return window->data[window->channels * position + channel] - getWindowChannelDcOffset(window, channel);
+}
+
 #endif